@@ -22,11 +22,15 @@
 
 #include <algorithm>
 #include <fstream>
+#include <limits>
+#include <type_traits>
 #include <vector>
 
+#include <generators.hpp>
 #include <si_units.hpp>
+#include <xss/common/mapped_text.hpp>
 
-static uint8_t standardize(std::vector<uint8_t>& vector) {
+static uint64_t standardize(std::vector<uint8_t>& vector) {
 
   std::vector<bool> char_occurs(256, false);
   for (uint64_t i = 1; i < vector.size() - 1; ++i) {
@@ -83,10 +87,76 @@ static uint8_t standardize(std::vector<uint8_t>& vector) {
   return sigma;
 }
 
-// adds sentinels
-static std::vector<uint8_t> file_to_instance(const std::string& file_name,
-                                             const uint64_t prefix_size,
-                                             uint8_t& sigma) {
+// Integer alphabets (2 or 4 bytes per character). The alphabet size is only
+// computed (and returned) if the characters have to be renamed, otherwise the
+// result is 0.
+template <typename value_type>
+static uint64_t standardize(std::vector<value_type>& vector) {
+  constexpr value_type max_value = std::numeric_limits<value_type>::max();
+  value_type max_char = 0;
+  bool contains_null = false;
+  for (uint64_t i = 1; i < vector.size() - 1; ++i) {
+    max_char = std::max(max_char, vector[i]);
+    contains_null |= (vector[i] == 0);
+  }
+  std::cout << "[STANDARDIZE]         Largest character: "
+            << (uint64_t) max_char << "." << std::endl;
+
+  uint64_t sigma = 0;
+  if (contains_null && max_char < max_value) {
+    std::cout << "[STANDARDIZE]         Text contains null-characters. "
+                 "Incrementing all characters. This does not influence the "
+                 "resulting data structures."
+              << std::endl;
+    for (uint64_t i = 1; i < vector.size() - 1; ++i)
+      ++vector[i];
+  } else if (contains_null) {
+    std::vector<value_type> alphabet(vector.begin() + 1, vector.end() - 1);
+    std::sort(alphabet.begin(), alphabet.end());
+    alphabet.erase(std::unique(alphabet.begin(), alphabet.end()),
+                   alphabet.end());
+    sigma = alphabet.size();
+    std::cout << "[STANDARDIZE]         Alphabet size: sigma=" << sigma << "."
+              << std::endl;
+    if (sigma > max_value) {
+      std::cerr << "[STANDARDIZE ERROR]   Cannot add sentinels (no unused "
+                   "characters)."
+                << std::endl;
+      std::cerr << "[STANDARDIZE WARNING] Replacing all null-characters with "
+                   "1-characters.\n"
+                << "                      This may influence the resulting "
+                   "data structures."
+                << std::endl;
+      for (uint64_t i = 1; i < vector.size() - 1; ++i)
+        vector[i] = std::max(vector[i], (value_type) 1);
+      sigma = max_value;
+    } else {
+      std::cout << "[STANDARDIZE]         Text contains null-characters and "
+                   "all other characters. Renaming the characters by their "
+                   "rank. This does not influence the resulting data "
+                   "structures."
+                << std::endl;
+      for (uint64_t i = 1; i < vector.size() - 1; ++i)
+        vector[i] = 1 + (std::lower_bound(alphabet.begin(), alphabet.end(),
+                                          vector[i]) -
+                         alphabet.begin());
+    }
+  }
+
+  std::cout
+      << "[STANDARDIZE]         Adding sentinels at beginning and end of text."
+      << std::endl;
+  vector[0] = 0;
+  vector[vector.size() - 1] = 0;
+  return sigma;
+}
+
+// Adds sentinels. Texts with wider characters (value_type = uint16_t or
+// uint32_t) are read as binary little-endian integers.
+template <typename value_type = uint8_t>
+static std::vector<value_type> file_to_instance(const std::string& file_name,
+                                                const uint64_t prefix_size,
+                                                uint64_t& sigma) {
   std::ifstream stream(file_name.c_str(), std::ios::in | std::ios::binary);
 
   if (!stream) {
@@ -95,19 +165,37 @@ static std::vector<uint8_t> file_to_instance(const std::string& file_name,
   }
 
   stream.seekg(0, std::ios::end);
-  uint64_t size_in_characters = stream.tellg();
+  const uint64_t file_size = stream.tellg();
+  uint64_t size_in_characters = file_size / sizeof(value_type);
   stream.seekg(0);
 
+  if (file_size % sizeof(value_type) != 0) {
+    std::cerr << "[WARNING] The size of file " << file_name
+              << " is not a multiple of " << sizeof(value_type)
+              << " bytes. Ignoring the last " << file_size % sizeof(value_type)
+              << " bytes." << std::endl;
+  }
+
   if (prefix_size > 0) {
     size_in_characters = std::min(prefix_size, size_in_characters);
   }
-  uint64_t size_in_bytes = size_in_characters;
+  uint64_t size_in_bytes = size_in_characters * sizeof(value_type);
 
   // +2 sentinels
-  std::vector<uint8_t> result(size_in_characters + 2);
+  std::vector<value_type> result(size_in_characters + 2);
   stream.read(reinterpret_cast<char*>(&(result.data()[1])), size_in_bytes);
   stream.close();
 
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  if constexpr (sizeof(value_type) == 2) {
+    for (auto& character : result)
+      character = __builtin_bswap16(character);
+  } else if constexpr (sizeof(value_type) == 4) {
+    for (auto& character : result)
+      character = __builtin_bswap32(character);
+  }
+#endif
+
   std::cout << "Finished reading file \"" << file_name << "\"." << std::endl;
   std::cout << "Size (w/o sentinels): "
             << "[" << size_in_characters << " characters] = "
@@ -119,8 +207,92 @@ static std::vector<uint8_t> file_to_instance(const std::string& file_name,
   return result;
 }
 
-[[maybe_unused]] static std::vector<uint8_t>
-file_to_instance(const std::string& file_name, const uint64_t prefix_size) {
-  uint8_t dummy;
-  return file_to_instance(file_name, prefix_size, dummy);
-}
\ No newline at end of file
+template <typename value_type = uint8_t>
+static std::vector<value_type> file_to_instance(const std::string& file_name,
+                                                const uint64_t prefix_size) {
+  uint64_t dummy;
+  return file_to_instance<value_type>(file_name, prefix_size, dummy);
+}
+
+// Generates a synthetic text with sentinels (see generate_instance).
+template <typename value_type = uint8_t>
+static std::vector<value_type> generated_instance(const std::string& family,
+                                                  const uint64_t size,
+                                                  const uint64_t seed,
+                                                  uint64_t& sigma) {
+  std::vector<value_type> result =
+      generate_instance<value_type>(family, size, seed);
+  if (result.size() == 0) {
+    std::cerr << "Unknown text family " << family << ".\n";
+    exit(EXIT_FAILURE);
+  }
+
+  const uint64_t size_in_bytes = size * sizeof(value_type);
+  std::cout << "Finished generating text \"" << family << "\" (seed " << seed
+            << ")." << std::endl;
+  std::cout << "Size (w/o sentinels): "
+            << "[" << size << " characters] = "
+            << ((size_in_bytes > 1023)
+                    ? ("[" + std::to_string(size_in_bytes) + " bytes] = ")
+                    : "")
+            << "[" << to_SI_string(size_in_bytes) << "]" << std::endl;
+  sigma = standardize(result);
+  return result;
+}
+
+// either a standardized copy of the text, or the memory-mapped file (only
+// for 1-byte characters)
+template <typename value_type = uint8_t>
+struct text_instance {
+  std::vector<value_type> copy;
+  xss::mapped_text mapped;
+
+  const value_type* data() const {
+    if constexpr (std::is_same_v<value_type, uint8_t>)
+      return mapped ? mapped.data() : copy.data();
+    else
+      return copy.data();
+  }
+
+  uint64_t size() const {
+    return mapped ? mapped.size() : copy.size();
+  }
+};
+
+// maps the file without copying it, sentinels are added virtually (falls back
+// to file_to_instance if the text contains null-characters)
+static text_instance<> file_to_mapped_instance(const std::string& file_name,
+                                               const uint64_t prefix_size,
+                                               const bool populate,
+                                               const bool sequential,
+                                               uint64_t& sigma) {
+  text_instance<> result;
+  result.mapped =
+      xss::mapped_text(file_name, prefix_size, populate, sequential);
+
+  if (!result.mapped) {
+    std::cerr << "File " << file_name << " could not be mapped.\n";
+    exit(EXIT_FAILURE);
+  }
+
+  if (result.mapped.contains_null()) {
+    std::cout << "[MMAP]                Text contains null-characters, "
+                 "reading and standardizing a copy instead."
+              << std::endl;
+    result.mapped = xss::mapped_text();
+    result.copy = file_to_instance(file_name, prefix_size, sigma);
+    return result;
+  }
+
+  const uint64_t size_in_bytes = result.mapped.size() - 2;
+  std::cout << "Finished mapping file \"" << file_name << "\"." << std::endl;
+  std::cout << "Size (w/o sentinels): "
+            << "[" << size_in_bytes << " characters] = "
+            << ((size_in_bytes > 1023)
+                    ? ("[" + std::to_string(size_in_bytes) + " bytes] = ")
+                    : "")
+            << "[" << to_SI_string(size_in_bytes) << "]" << std::endl;
+  // computing the alphabet size would require an additional scan
+  sigma = 0;
+  return result;
+}
@@ -0,0 +1,251 @@
+//  Copyright (c) 2019 Jonas Ellert
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+// Synthetic texts for the benchmark (--generate). Each generator writes the
+// characters of a text of length n into text[1..n] of a vector of length
+// n + 2, the sentinels text[0] and text[n + 1] are zero. All generators take
+// linear time and only logarithmic additional space, so they scale to very
+// long texts.
+//
+// The families random, run-of-runs, overlap and lookahead correspond to the
+// instances of the test suite (see benchmark/test/strings).
+namespace generators {
+
+  // SplitMix64, which is much faster than std::mt19937_64 and good enough
+  // for synthetic texts.
+  struct rng_type {
+    uint64_t state;
+
+    rng_type(const uint64_t seed) : state(seed) {}
+
+    uint64_t operator()() {
+      uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+      return z ^ (z >> 31);
+    }
+  };
+
+  // Uniformly random characters from [1, sigma]. Each random word yields two
+  // characters (by multiply-shift on its halves, which avoids the division).
+  template <typename value_type>
+  static void random(std::vector<value_type>& text,
+                     const uint64_t n,
+                     const uint64_t sigma,
+                     rng_type& rng) {
+    constexpr uint64_t low_half = (1ULL << 32) - 1;
+    for (uint64_t i = 1; i <= n; i += 2) {
+      const uint64_t bits = rng();
+      text[i] = 1 + (((bits & low_half) * sigma) >> 32);
+      if (i < n)
+        text[i + 1] = 1 + (((bits >> 32) * sigma) >> 32);
+    }
+  }
+
+  // The prefix of length n of the infinite Fibonacci word abaababaabaab...
+  // (fixed point of a -> ab, b -> a). Each Fibonacci word is the
+  // concatenation of the two previous ones, and the shorter one is a prefix.
+  template <typename value_type>
+  static void fibonacci(std::vector<value_type>& text, const uint64_t n) {
+    value_type* word = text.data() + 1;
+    if (n > 0)
+      word[0] = 'a';
+    if (n > 1)
+      word[1] = 'b';
+    // lengths of the last two Fibonacci words
+    uint64_t previous = 1, current = 2;
+    while (current < n) {
+      std::copy(word, word + std::min(previous, n - current), word + current);
+      const uint64_t next = current + previous;
+      previous = current;
+      current = next;
+    }
+  }
+
+  // The prefix of length n of the Thue-Morse word abbabaabbaababba...
+  template <typename value_type>
+  static void thue_morse(std::vector<value_type>& text, const uint64_t n) {
+    for (uint64_t i = 0; i < n; ++i)
+      text[i + 1] = 'a' + (__builtin_popcountll(i) & 1);
+  }
+
+  // The prefix of length n of the period-doubling word abaaabababaaabaa...
+  template <typename value_type>
+  static void period_doubling(std::vector<value_type>& text,
+                              const uint64_t n) {
+    for (uint64_t i = 0; i < n; ++i)
+      text[i + 1] = 'a' + (__builtin_ctzll(i + 1) & 1);
+  }
+
+  // Same text as generate_test_run_of_runs: nested runs, where each period
+  // consists of a new character followed by repetitions copies of the period
+  // of the next level.
+  template <typename value_type>
+  static void run_of_runs(std::vector<value_type>& text,
+                          const uint64_t n,
+                          const uint64_t repetitions) {
+    value_type alphabet_size = 1;
+    {
+      uint64_t build_n = repetitions;
+      while (build_n < n) {
+        build_n = (build_n + 1) * repetitions;
+        ++alphabet_size;
+      }
+    }
+    if (n < alphabet_size) {
+      for (uint64_t i = 1; i <= n; ++i)
+        text[i] = 'A';
+      return;
+    }
+
+    text[alphabet_size] = 'A' + alphabet_size - 1;
+    uint64_t period_len = 1;
+    for (value_type cc = alphabet_size - 1; cc > 0; --cc) {
+      text[cc] = text[cc + 1] - 1;
+      const uint64_t remaining = period_len * (repetitions - 1);
+      for (uint64_t i = 0; i < remaining && cc + period_len + i < n; ++i)
+        text[cc + period_len + i + 1] = text[cc + i + 1];
+      period_len = (period_len * repetitions) + 1;
+    }
+    for (uint64_t i = period_len; i < n; ++i)
+      text[i + 1] = text[i + 1 - period_len];
+  }
+
+  // Same text as generate_test_high_overlap: s = (c s')^2, where s' is the
+  // text of the next smaller character, repeated up to length n. The text is
+  // built backwards (reverse(s) = (reverse(s') c)^2) and then reversed.
+  template <typename value_type>
+  static void overlap(std::vector<value_type>& text, const uint64_t n) {
+    std::vector<uint64_t> lengths;
+    for (uint64_t len = n; len >= 2; len = (len - 2) / 2)
+      lengths.push_back(len);
+    value_type* word = text.data() + 1;
+    uint64_t size = 0;
+    for (uint64_t k = lengths.size(); k > 0; --k) {
+      word[size++] = 'A' + k - 1;
+      std::copy(word, word + size, word + size);
+      size <<= 1;
+    }
+    std::reverse(word, word + size);
+    if (size == 0)
+      std::fill(word, word + n, 'A');
+    for (uint64_t i = size; size > 0 && i < n; ++i)
+      word[i] = word[i - size];
+  }
+
+  // Repeats blocks of the form p [x] p [x] p, where each x is a random
+  // separator (none, G or Z), and p consists of a random prefix, a periodic
+  // part and a random suffix (each of random length below max_block). These
+  // are the patterns of get_instances_for_lookahead_test, which make the
+  // lookahead copy long intervals.
+  template <typename value_type>
+  static void lookahead(std::vector<value_type>& text,
+                        const uint64_t n,
+                        const uint64_t max_block,
+                        rng_type& rng) {
+    value_type* word = text.data() + 1;
+    uint64_t size = 0;
+    auto append = [&](const value_type c) {
+      if (size < n)
+        word[size++] = c;
+    };
+    while (size < n) {
+      const uint64_t begin = size;
+      append('A');
+      for (uint64_t i = rng() % max_block; i > 0; --i)
+        append('B' + rng() % 25);
+      value_type period[8];
+      const uint64_t period_len = 1 + rng() % 8;
+      for (uint64_t i = 0; i < period_len; ++i)
+        period[i] = 'B' + rng() % 24;
+      for (uint64_t i = rng() % max_block; i > 0; --i)
+        append(period[i % period_len]);
+      for (uint64_t i = rng() % max_block; i > 0; --i)
+        append('B' + rng() % 25);
+
+      const uint64_t length = size - begin;
+      for (uint64_t copy = 0; copy < 2; ++copy) {
+        const uint64_t separator = rng() % 3;
+        if (separator > 0)
+          append((separator == 1) ? 'G' : 'Z');
+        for (uint64_t i = 0; i < length; ++i)
+          append(word[begin + i]);
+      }
+    }
+  }
+
+} // namespace generators
+
+// Generates the given family (name[:parameter]) with n characters (plus
+// sentinels). Returns an empty vector if the family is unknown.
+template <typename value_type = uint8_t>
+static std::vector<value_type> generate_instance(const std::string& family,
+                                                 const uint64_t n,
+                                                 const uint64_t seed) {
+  const auto colon = family.find(':');
+  const std::string name = family.substr(0, colon);
+  // the optional parameter (or the given default)
+  auto parameter = [&](const uint64_t default_value) -> uint64_t {
+    if (colon == std::string::npos)
+      return default_value;
+    return std::stoull(family.substr(colon + 1));
+  };
+
+  std::vector<value_type> result(n + 2);
+  generators::rng_type rng(seed);
+  if (name == "random") {
+    const uint64_t max_sigma = std::numeric_limits<value_type>::max();
+    generators::random(result, n,
+                       std::clamp(parameter(4), (uint64_t) 1, max_sigma), rng);
+  } else if (name == "fibonacci") {
+    generators::fibonacci(result, n);
+  } else if (name == "thue-morse") {
+    generators::thue_morse(result, n);
+  } else if (name == "period-doubling") {
+    generators::period_doubling(result, n);
+  } else if (name == "run-of-runs") {
+    generators::run_of_runs(result, n, std::max(parameter(2), (uint64_t) 2));
+  } else if (name == "overlap") {
+    generators::overlap(result, n);
+  } else if (name == "lookahead") {
+    generators::lookahead(result, n, std::max(parameter(1024), (uint64_t) 1),
+                          rng);
+  } else {
+    return {};
+  }
+  return result;
+}
+
+// The available families (for --list and error messages).
+inline static const std::vector<std::string>& generator_families() {
+  const static std::vector<std::string> families = {
+      "random[:sigma]", "fibonacci", "thue-morse", "period-doubling",
+      "run-of-runs[:repetitions]", "overlap", "lookahead[:max_block]"};
+  return families;
+}
@@ -0,0 +1,177 @@
+//  Copyright (c) 2019 Jonas Ellert
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+constexpr static uint64_t perf_cache_miss(const uint64_t cache) {
+  return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+         (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+#endif
+
+// Hardware counters of the calling thread (and of the threads that it spawns
+// after the counters have been opened), measured with perf_event_open. Each
+// event is counted on its own, so events that the kernel or the CPU does not
+// support are simply left out. If the kernel multiplexes the counters, the
+// values are scaled to the full measurement time.
+struct perf_counters {
+  struct event {
+    const char* name;
+    uint32_t type;
+    uint64_t config;
+  };
+
+#ifdef __linux__
+  constexpr static event events[] = {
+      {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+      {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+      {"l1d_misses", PERF_TYPE_HW_CACHE,
+       perf_cache_miss(PERF_COUNT_HW_CACHE_L1D)},
+      {"llc_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+      {"branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+      {"dtlb_misses", PERF_TYPE_HW_CACHE,
+       perf_cache_miss(PERF_COUNT_HW_CACHE_DTLB)}};
+#else
+  constexpr static event events[] = {{"cycles", 0, 0}};
+#endif
+  constexpr static uint64_t number_of_events = std::size(events);
+
+  using values = std::array<double, number_of_events>;
+
+  int fds[number_of_events];
+
+  perf_counters() {
+    uint64_t available = 0;
+    for (uint64_t k = 0; k < number_of_events; ++k) {
+      fds[k] = open_event(events[k]);
+      available += (fds[k] >= 0) ? 1 : 0;
+    }
+    static bool warned = false;
+    if (available == 0 && !warned) {
+      warned = true;
+      std::cerr << "[PERF WARNING]   Hardware counters are not available "
+                   "(see /proc/sys/kernel/perf_event_paranoid)."
+                << std::endl;
+    }
+  }
+
+  perf_counters(const perf_counters&) = delete;
+  perf_counters& operator=(const perf_counters&) = delete;
+
+  ~perf_counters() {
+#ifdef __linux__
+    for (uint64_t k = 0; k < number_of_events; ++k)
+      if (fds[k] >= 0)
+        close(fds[k]);
+#endif
+  }
+
+  void begin() {
+#ifdef __linux__
+    for (uint64_t k = 0; k < number_of_events; ++k) {
+      if (fds[k] >= 0) {
+        ioctl(fds[k], PERF_EVENT_IOC_RESET, 0);
+        ioctl(fds[k], PERF_EVENT_IOC_ENABLE, 0);
+      }
+    }
+#endif
+  }
+
+  void end() {
+#ifdef __linux__
+    for (uint64_t k = 0; k < number_of_events; ++k)
+      if (fds[k] >= 0)
+        ioctl(fds[k], PERF_EVENT_IOC_DISABLE, 0);
+#endif
+  }
+
+  // Counters of the last measurement (negative if not available).
+  values read_values() const {
+    values result;
+    result.fill(-1.0);
+#ifdef __linux__
+    for (uint64_t k = 0; k < number_of_events; ++k) {
+      uint64_t buffer[3]; // value, time enabled, time running
+      if (fds[k] < 0 || read(fds[k], buffer, sizeof(buffer)) !=
+                            (ssize_t) sizeof(buffer))
+        continue;
+      if (buffer[2] == 0)
+        result[k] = 0.0;
+      else
+        result[k] = buffer[0] * ((double) buffer[1] / buffer[2]);
+    }
+#endif
+    return result;
+  }
+
+  // Median of each counter over the given measurements, normalized by n.
+  static std::string to_string(std::vector<values> measurements,
+                               const uint64_t n) {
+    if (measurements.empty())
+      return "";
+    std::stringstream result;
+    for (uint64_t k = 0; k < number_of_events; ++k) {
+      std::vector<double> counts;
+      for (const auto& measurement : measurements)
+        counts.push_back(measurement[k]);
+      std::sort(counts.begin(), counts.end());
+      const double median = counts[counts.size() >> 1];
+      if (median >= 0)
+        result << " " << events[k].name << "_per_char=" << (median / n);
+    }
+    return result.str();
+  }
+
+private:
+  static int open_event(const event& e) {
+#ifdef __linux__
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = e.type;
+    attr.config = e.config;
+    attr.disabled = 1;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format =
+        PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#else
+    (void) e;
+    return -1;
+#endif
+  }
+};
@@ -20,7 +20,110 @@
 
 #pragma once
 
+#include <fstream>
+#include <memory>
+#include <perf_counters.hpp>
+#include <sstream>
 #include <time_measure.hpp>
+#include <xss/common/statistics.hpp>
+
+// Set by the command line options of the benchmark.
+struct run_settings {
+  uint64_t warmup_runs = 0;
+  // adds the median hardware counters of the runs (per character) to the
+  // results
+  bool perf = false;
+  // if not empty, each measured run is appended to these files
+  std::string csv_file = "";
+  std::string json_file = "";
+};
+
+inline run_settings run_config;
+
+// Splits "key=value key=value ..." into its pairs.
+static inline std::vector<std::pair<std::string, std::string>>
+split_info(const std::string& info) {
+  std::vector<std::pair<std::string, std::string>> result;
+  std::stringstream tokens(info);
+  std::string token;
+  while (tokens >> token) {
+    const auto eq = token.find('=');
+    if (eq == std::string::npos)
+      result.emplace_back(token, "");
+    else
+      result.emplace_back(token.substr(0, eq), token.substr(eq + 1));
+  }
+  return result;
+}
+
+static inline std::string quoted(const std::string& str, const bool json) {
+  std::string result = "\"";
+  for (const char c : str) {
+    if (c == '"')
+      result += json ? "\\\"" : "\"\"";
+    else if (json && c == '\\')
+      result += "\\\\";
+    else if (json && (unsigned char) c < 0x20)
+      result += "\\u00" + std::string(1, "0123456789abcdef"[c >> 4]) +
+                "0123456789abcdef"[c & 15];
+    else
+      result += c;
+  }
+  return result + "\"";
+}
+
+// One CSV row (or one JSON object per line) for each measured run.
+static inline void
+write_runs(const std::string& algo,
+           const std::string& info,
+           const uint64_t n,
+           const time_mem_summary& summary,
+           const std::vector<perf_counters::values>& counter_values) {
+  const bool perf = (counter_values.size() > 0);
+  if (run_config.csv_file.size() > 0) {
+    const bool empty =
+        std::ifstream(run_config.csv_file, std::ios::ate).tellg() <= 0;
+    std::ofstream csv(run_config.csv_file, std::ios::app);
+    if (empty) {
+      csv << "algo,info,n,run,time_ns,memory,chars_per_sec";
+      for (const auto& event : perf_counters::events)
+        csv << "," << event.name << "_per_char";
+      csv << "\n";
+    }
+    for (uint64_t r = 0; r < summary.runs.size(); ++r) {
+      const auto& run = summary.runs[r];
+      csv << quoted(algo, false) << "," << quoted(info, false) << "," << n
+          << "," << r << "," << run.time << "," << run.memory << ","
+          << (n * 1e9 / std::max((uint64_t) 1, run.time));
+      for (uint64_t k = 0; k < perf_counters::number_of_events; ++k) {
+        csv << ",";
+        if (perf && counter_values[r][k] >= 0)
+          csv << (counter_values[r][k] / n);
+      }
+      csv << "\n";
+    }
+  }
+
+  if (run_config.json_file.size() > 0) {
+    std::ofstream json(run_config.json_file, std::ios::app);
+    for (uint64_t r = 0; r < summary.runs.size(); ++r) {
+      const auto& run = summary.runs[r];
+      json << "{\"algo\":" << quoted(algo, true);
+      for (const auto& kv : split_info(info))
+        json << "," << quoted(kv.first, true) << ":"
+             << quoted(kv.second, true);
+      json << ",\"n\":" << n << ",\"run\":" << r
+           << ",\"time_ns\":" << run.time << ",\"memory\":" << run.memory
+           << ",\"chars_per_sec\":"
+           << (n * 1e9 / std::max((uint64_t) 1, run.time));
+      for (uint64_t k = 0; k < perf_counters::number_of_events; ++k)
+        if (perf && counter_values[r][k] >= 0)
+          json << ",\"" << perf_counters::events[k].name
+               << "_per_char\":" << (counter_values[r][k] / n);
+      json << "}\n";
+    }
+  }
+}
 
 template <typename runner_type, typename teardown_type>
 void run_generic(const std::string algo,
@@ -33,15 +136,71 @@ void run_generic(const std::string algo,
   std::cout << "RESULT algo=" << algo << " " << info << " runs=" << runs
             << " n=" << n << " " << std::flush;
 
-  std::pair<uint64_t, uint64_t> time_mem = get_time_mem(runner, teardown, runs);
+  // the hardware counters are opened only once, and they measure nothing but
+  // the runner itself (the warmup runs come first)
+  const uint64_t warmup_runs = run_config.warmup_runs;
+  std::unique_ptr<perf_counters> counters;
+  std::vector<perf_counters::values> counter_values;
+  uint64_t run = 0;
+  if (run_config.perf) {
+    counters = std::make_unique<perf_counters>();
+    counter_values.resize(warmup_runs + runs);
+  }
 
-  const uint64_t additional_memory = time_mem.second;
-  auto mibs = (n / 1024.0 / 1024.0) / (time_mem.first / 1000.0);
+#ifdef XSS_STATISTICS
+  // the construction is deterministic, so we report the last run only
+  xss::statistics stats;
+#endif
+  // the statistics and the counters are reset and read outside of the timed
+  // region, such that the times with and without --perf are comparable
+  auto pre = [&]() {
+#ifdef XSS_STATISTICS
+    xss::reset_statistics();
+#endif
+    if (counters)
+      counters->begin();
+  };
+  auto post = [&]() {
+    if (counters) {
+      counters->end();
+      counter_values[run++] = counters->read_values();
+    }
+#ifdef XSS_STATISTICS
+    stats = xss::get_statistics();
+#endif
+    teardown();
+  };
+  const time_mem_summary summary =
+      get_time_mem(pre, runner, post, runs, warmup_runs);
+  if (counters)
+    counter_values.erase(counter_values.begin(),
+                         counter_values.begin() + warmup_runs);
+
+  const uint64_t median_time = std::max((uint64_t) 1, summary.median_time);
+  const uint64_t additional_memory = summary.median_memory;
+  auto chars_per_sec = n / (median_time / 1e9);
+  auto mibs = chars_per_sec / 1024.0 / 1024.0;
   auto additional_bpn = (8.0 * additional_memory) / n;
 
-  std::cout << "median_time=" << time_mem.first << " mibs=" << mibs
+  // times in milliseconds (fractional), except for the *_ns fields
+  std::cout << "warmup_runs=" << warmup_runs
+            << " median_time=" << (summary.median_time / 1e6)
+            << " min_time=" << (summary.min_time / 1e6)
+            << " mean_time=" << (summary.mean_time / 1e6)
+            << " p90_time=" << (summary.p90_time / 1e6)
+            << " stddev_time=" << (summary.stddev_time / 1e6)
+            << " median_ns=" << summary.median_time
+            << " chars_per_sec=" << chars_per_sec << " mibs=" << mibs
             << " additional_memory=" << additional_memory
-            << " additional_bpn=" << additional_bpn << std::endl;
+            << " additional_bpn=" << additional_bpn;
+  if (counters)
+    std::cout << perf_counters::to_string(counter_values, n);
+#ifdef XSS_STATISTICS
+  std::cout << " " << stats.to_string();
+#endif
+  std::cout << std::endl;
+
+  write_runs(algo, info, n, summary, counter_values);
 }
 
 template <typename runner_type>
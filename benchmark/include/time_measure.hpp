@@ -22,19 +22,26 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <malloc_count.h>
 #include <sstream>
+#include <vector>
 
 struct time_measure {
-  decltype(std::chrono::high_resolution_clock::now()) begin_;
-  decltype(std::chrono::high_resolution_clock::now()) end_;
+  decltype(std::chrono::steady_clock::now()) begin_;
+  decltype(std::chrono::steady_clock::now()) end_;
 
   void begin() {
-    begin_ = std::chrono::high_resolution_clock::now();
+    begin_ = std::chrono::steady_clock::now();
   }
 
   void end() {
-    end_ = std::chrono::high_resolution_clock::now();
+    end_ = std::chrono::steady_clock::now();
+  }
+
+  uint64_t nanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(end_ - begin_)
+        .count();
   }
 
   uint64_t millis() {
@@ -43,42 +50,93 @@ struct time_measure {
   }
 };
 
-template <typename func_type, typename post_type>
-static inline std::pair<uint64_t, uint64_t> get_time_mem(const func_type& func,
-                                                         const post_type& post,
-                                                         const uint64_t runs) {
-  std::vector<uint64_t> times(runs);
-  std::vector<std::pair<uint64_t, uint64_t>> mem_times(runs);
+// Time (in nanoseconds) and additional memory (in bytes) of a single run.
+struct run_measurement {
+  uint64_t time = 0;
+  uint64_t memory = 0;
+};
+
+struct time_mem_summary {
+  std::vector<run_measurement> runs;
+  uint64_t min_time = 0;
+  uint64_t median_time = 0;
+  uint64_t p90_time = 0;
+  double mean_time = 0;
+  double stddev_time = 0;
+  // additional memory of the run with the median time
+  uint64_t median_memory = 0;
+
+  time_mem_summary(std::vector<run_measurement> measurements)
+      : runs(std::move(measurements)) {
+    if (runs.size() == 0)
+      return;
+    std::vector<run_measurement> sorted = runs;
+    std::sort(sorted.begin(), sorted.end(),
+              [](const run_measurement& lhs, const run_measurement& rhs) {
+                return lhs.time < rhs.time;
+              });
+    const uint64_t count = sorted.size();
+    min_time = sorted.front().time;
+    median_time = sorted[count >> 1].time;
+    median_memory = sorted[count >> 1].memory;
+    // nearest rank
+    p90_time = sorted[(count * 9 + 9) / 10 - 1].time;
+
+    for (const auto& run : sorted)
+      mean_time += run.time;
+    mean_time /= count;
+    if (count > 1) {
+      for (const auto& run : sorted)
+        stddev_time += (run.time - mean_time) * (run.time - mean_time);
+      stddev_time = std::sqrt(stddev_time / (count - 1));
+    }
+  }
+};
+
+// Executes func warmup_runs times without measuring it, and then measures
+// func for the given number of runs. The functions pre and post are executed
+// right before and after each run (and not measured).
+template <typename pre_type, typename func_type, typename post_type>
+static inline time_mem_summary get_time_mem(const pre_type& pre,
+                                            const func_type& func,
+                                            const post_type& post,
+                                            const uint64_t runs,
+                                            const uint64_t warmup_runs = 0) {
+  for (uint64_t i = 0; i < warmup_runs; ++i) {
+    pre();
+    func();
+    post();
+  }
 
+  std::vector<run_measurement> measurements(runs);
   for (uint64_t i = 0; i < runs; ++i) {
     time_measure time_measurement;
     malloc_count_reset_peak();
     uint64_t mem_pre = malloc_count_current();
 
+    pre();
     time_measurement.begin();
     func();
     time_measurement.end();
     post();
-    uint64_t time = time_measurement.millis();
-    times[i] = time;
+    measurements[i].time = time_measurement.nanos();
 
     uint64_t mem_peak = malloc_count_peak();
-    uint64_t memory = mem_peak - mem_pre;
-    mem_times[i] = {memory, time};
+    measurements[i].memory = mem_peak - mem_pre;
   }
-  std::sort(times.begin(), times.end());
-  const uint64_t median_time = std::max((uint64_t) 1, times[runs >> 1]);
+  return time_mem_summary(std::move(measurements));
+}
 
-  uint64_t median_mem = std::numeric_limits<uint64_t>::max();
-  for (const auto& mem_time : mem_times) {
-    if (mem_time.second == median_time && mem_time.first < median_mem)
-      median_mem = mem_time.first;
-  }
-  return {median_time, median_mem};
+template <typename func_type, typename post_type>
+static inline time_mem_summary get_time_mem(const func_type& func,
+                                            const post_type& post,
+                                            const uint64_t runs,
+                                            const uint64_t warmup_runs = 0) {
+  return get_time_mem([]() {}, func, post, runs, warmup_runs);
 }
 
 template <typename func_type>
-static inline std::pair<uint64_t, uint64_t> get_time_mem(const func_type& func,
-                                                         const uint64_t runs) {
+static inline time_mem_summary get_time_mem(const func_type& func,
+                                            const uint64_t runs) {
   return get_time_mem(func, []() {}, runs);
-}
\ No newline at end of file
+}
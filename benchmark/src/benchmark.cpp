@@ -6,15 +6,27 @@
 #include <lyndon-isa-nsv.hpp>
 #include <run_algorithm.hpp>
 #include <sstream>
+#include <thread>
 #include <tlx/cmdline_parser.hpp>
 
 struct {
   std::vector<std::string> file_paths;
+  std::vector<std::string> families;
+  uint64_t seed = 0;
   uint64_t bytes_per_char = 1;
   uint64_t number_of_runs = 5;
   uint64_t prefix_size = 0;
+  bool mmap = false;
+  bool populate = false;
+  bool sequential = false;
+  std::string thresholds = "";
+  bool auto_threshold = false;
+  uint64_t threads = 0;
   std::string contains = "";
   std::string not_contains = "";
+  std::string pages = "standard";
+  std::string numa = "first-touch";
+  xss::memory_options output_memory;
   bool list = false;
 
   bool matches(const std::string algo) const {
@@ -41,220 +53,638 @@ struct {
 
 } s;
 
-int main(int argc, char const* argv[]) {
-  tlx::CmdlineParser cp;
-  cp.set_description("Nearest Smaller Suffix Construction");
-  cp.set_author("Jonas Ellert <jonas.ellert@tu-dortmund.de>");
+// Output array of the xss algorithms, allocated as configured with --pages and
+// --numa. Like the std::vector it replaces, it is populated up front. The
+// outputs are mapped, so they are not part of the reported memory.
+template <typename value_type>
+struct output_array {
+  xss::large_buffer buffer;
 
-  cp.add_stringlist('f', "file", s.file_paths, "Path(s) to the text file(s).");
+  output_array(const uint64_t n) : buffer(n * sizeof(value_type), options()) {}
 
-  cp.add_bytes('r', "runs", s.number_of_runs,
-               "Number of repetitions of the algorithm (default = 5).");
-  cp.add_bytes('l', "length", s.prefix_size,
-               "Length of the prefix of the text that should be considered.");
+  value_type* data() {
+    return buffer.data<value_type>();
+  }
 
-  cp.add_string('\0', "contains", s.contains,
-                "Only execute algorithms that contain at least one of the "
-                "given strings (comma separated).");
-  cp.add_string('\0', "not-contains", s.not_contains,
-                "Only execute algorithms that contain none of the given "
-                "strings (comma separated).");
+  static xss::memory_options options() {
+    xss::memory_options result = s.output_memory;
+    result.populate = true;
+    return result;
+  }
+};
 
-  cp.add_flag('\0', "list", s.list, "List the available algorithms.");
+// Output bit vector of the xss algorithms (not populated, like the malloc'ed
+// xss::bit_vector).
+static xss::bit_vector output_bits(const uint64_t n) {
+  return xss::bit_vector(n, s.output_memory);
+}
 
-  if (!cp.process(argc, argv)) {
-    return -1;
-  }
+template <typename value_type>
+static void benchmark_text(const std::string& source,
+                           const text_instance<value_type>& text_vec,
+                           const uint64_t sigma) {
+  constexpr bool byte_text = std::is_same_v<value_type, uint8_t>;
+  const std::string info =
+      source + " sigma=" +
+      ((sigma > 0) ? std::to_string(sigma) : std::string("?")) +
+      " bytes_per_char=" + std::to_string(sizeof(value_type)) +
+      " pages=" + s.pages + " numa=" + s.numa;
 
-  if (s.list) {
-    std::cout << "Available algorithms:" << std::endl;
-    std::cout << "    "
-              << "lyndon-array" << std::endl;
-    std::cout << "    "
-              << "nss-array" << std::endl;
-    std::cout << "    "
-              << "pss-array" << std::endl;
-    std::cout << "    "
-              << "pss-and-lyndon-array" << std::endl;
-    std::cout << "    "
-              << "pss-and-nss-array" << std::endl;
-    std::cout << "    "
-              << "pss-tree" << std::endl;
-    std::cout << "    "
-              << "divsufsort" << std::endl;
-    return 0;
+  std::vector<uint64_t> thresholds;
+  std::stringstream threshold_list(s.thresholds);
+  while (threshold_list.good()) {
+    std::string threshold;
+    getline(threshold_list, threshold, ',');
+    if (threshold.size() > 0)
+      thresholds.push_back(std::stoull(threshold));
   }
+  if (s.auto_threshold) {
+    const uint64_t threshold =
+        xss::auto_threshold(text_vec.data(), text_vec.size());
+    std::cout << "Automatic threshold: " << threshold << std::endl;
+    thresholds.push_back(threshold);
+  }
+  if (thresholds.size() == 0)
+    thresholds.push_back(xss::internal::DEFAULT_THRESHOLD);
 
-  for (auto file : s.file_paths) {
-    uint8_t sigma = 0;
-    std::vector<uint8_t> text_vec =
-        file_to_instance(file, s.prefix_size, sigma);
-    const std::string info =
-        std::string("file=") + file + " sigma=" + std::to_string(sigma);
+  for (uint64_t t = 0; t < thresholds.size(); ++t) {
+    // the other algorithms do not depend on the threshold
+    const bool first = (t == 0);
+    const uint64_t threshold = thresholds[t];
+    const std::string threshold_info =
+        info + " threshold=" + std::to_string(threshold);
+    // the parallel algorithms report the number of threads
+    const std::string parallel_info =
+        threshold_info + " threads=" + std::to_string(s.threads);
 
     if (s.matches("pss-tree-plain")) {
-      xss::bit_vector bv(2 * text_vec.size() + 2);
+      auto bv = output_bits(2 * text_vec.size() + 2);
       auto runner = [&]() {
-        xss::pss_tree(text_vec.data(), bv.data(), text_vec.size());
+        xss::pss_tree(text_vec.data(), bv.data(), text_vec.size(), threshold);
       };
-      auto teardown = [&]() { bv = xss::bit_vector(2 * text_vec.size() + 2); };
-      run_generic("pss-tree-plain", info, text_vec.size() - 2, s.number_of_runs,
-                  runner, teardown);
+      auto teardown = [&]() {
+        bv = output_bits(2 * text_vec.size() + 2);
+      };
+      run_generic("pss-tree-plain", threshold_info, text_vec.size() - 2,
+                  s.number_of_runs, runner, teardown);
+    }
+
+    if (s.matches("parallel-pss-tree")) {
+      auto bv = output_bits(2 * text_vec.size() + 2);
+      auto runner = [&]() {
+        xss::parallel::pss_tree(text_vec.data(), bv.data(), text_vec.size(),
+                                s.threads, threshold);
+      };
+      auto teardown = [&]() {
+        bv = output_bits(2 * text_vec.size() + 2);
+      };
+      run_generic("parallel-pss-tree", parallel_info, text_vec.size() - 2,
+                  s.number_of_runs, runner, teardown);
+    }
+
+    if (s.matches("pss-tree-contiguous")) {
+      auto bv = output_bits(2 * text_vec.size() + 2);
+      auto runner = [&]() {
+        xss::pss_tree<uint64_t, contiguous_telescope_stack>(
+            text_vec.data(), bv.data(), text_vec.size(), threshold);
+      };
+      auto teardown = [&]() {
+        bv = output_bits(2 * text_vec.size() + 2);
+      };
+      run_generic("pss-tree-contiguous", threshold_info, text_vec.size() - 2,
+                  s.number_of_runs, runner, teardown);
+    }
+
+    if (s.matches("pss-tree-arena")) {
+      // the arena is allocated (and pre-faulted) once, so the runs should not
+      // need any additional memory
+      auto bv = output_bits(2 * text_vec.size() + 2);
+      xss::arena scratch(xss::pss_tree_arena_bytes(text_vec.size()));
+      auto runner = [&]() {
+        xss::pss_tree(scratch, text_vec.data(), bv.data(), text_vec.size(),
+                      threshold);
+      };
+      auto teardown = [&]() {
+        bv = output_bits(2 * text_vec.size() + 2);
+      };
+      run_generic("pss-tree-arena", threshold_info, text_vec.size() - 2,
+                  s.number_of_runs, runner, teardown);
+    }
+
+    if (s.matches("pss-tree-sliding")) {
+      // the words are only combined (instead of written to a file)
+      uint64_t checksum = 0;
+      auto runner = [&]() {
+        xss::pss_tree_to_sink(
+            text_vec.data(), text_vec.size(),
+            [&](const uint64_t* words, const uint64_t count) {
+              for (uint64_t w = 0; w < count; ++w)
+                checksum ^= words[w];
+            },
+            1ULL << 20, threshold);
+      };
+      run_generic("pss-tree-sliding", threshold_info, text_vec.size() - 2,
+                  s.number_of_runs, runner);
     }
 
     if (s.matches("pss-tree-support")) {
       sdsl::bit_vector bv(2 * text_vec.size() + 2);
       auto runner = [&]() {
-        xss::pss_tree(text_vec.data(), bv.data(), text_vec.size());
+        xss::pss_tree(text_vec.data(), bv.data(), text_vec.size(), threshold);
         auto support = xss::pss_tree_support_sdsl(bv);
       };
-      auto teardown = [&]() { bv = sdsl::bit_vector(2 * text_vec.size() + 2); };
-      run_generic("pss-tree-support", info, text_vec.size() - 2,
+      auto teardown = [&]() {
+        bv = sdsl::bit_vector(2 * text_vec.size() + 2);
+      };
+      run_generic("pss-tree-support", threshold_info, text_vec.size() - 2,
                   s.number_of_runs, runner, teardown);
     }
 
+    if (s.matches("pss-tree-support-xss")) {
+      auto bv = output_bits(2 * text_vec.size() + 2);
+      auto runner = [&]() {
+        xss::pss_tree(text_vec.data(), bv.data(), text_vec.size(), threshold);
+        auto support = xss::pss_tree_support(bv);
+      };
+      auto teardown = [&]() {
+        bv = output_bits(2 * text_vec.size() + 2);
+      };
+      run_generic("pss-tree-support-xss", threshold_info, text_vec.size() - 2,
+                  s.number_of_runs, runner, teardown);
+    }
+
+    if (s.matches("pss-tree-support-fused")) {
+      auto bv = output_bits(2 * text_vec.size() + 2);
+      auto runner = [&]() {
+        auto support = xss::pss_tree_with_support(
+            text_vec.data(), bv.data(), text_vec.size(), threshold);
+      };
+      auto teardown = [&]() {
+        bv = output_bits(2 * text_vec.size() + 2);
+      };
+      run_generic("pss-tree-support-fused", threshold_info,
+                  text_vec.size() - 2, s.number_of_runs, runner, teardown);
+    }
+
+    if (s.matches("parallel-lyndon-array32")) {
+      output_array<uint32_t> array(text_vec.size());
+      auto runner = [&]() {
+        xss::parallel::lyndon_array(text_vec.data(), array.data(),
+                                    text_vec.size(), s.threads, threshold);
+      };
+      run_generic("parallel-lyndon-array32", parallel_info,
+                  text_vec.size() - 2, s.number_of_runs, runner);
+    }
+
+    if (s.matches("parallel-nss-array32")) {
+      output_array<uint32_t> array(text_vec.size());
+      auto runner = [&]() {
+        xss::parallel::nss_array(text_vec.data(), array.data(),
+                                 text_vec.size(), s.threads, threshold);
+      };
+      run_generic("parallel-nss-array32", parallel_info, text_vec.size() - 2,
+                  s.number_of_runs, runner);
+    }
+
+    if (s.matches("parallel-lyndon-array-by-factors32")) {
+      output_array<uint32_t> array(text_vec.size());
+      auto runner = [&]() {
+        xss::parallel::lyndon_array_by_factors(text_vec.data(), array.data(),
+                                               text_vec.size(), s.threads,
+                                               threshold);
+      };
+      run_generic("parallel-lyndon-array-by-factors32", parallel_info,
+                  text_vec.size() - 2, s.number_of_runs, runner);
+    }
+
+    if (s.matches("parallel-nss-array-by-factors32")) {
+      output_array<uint32_t> array(text_vec.size());
+      auto runner = [&]() {
+        xss::parallel::nss_array_by_factors(text_vec.data(), array.data(),
+                                            text_vec.size(), s.threads,
+                                            threshold);
+      };
+      run_generic("parallel-nss-array-by-factors32", parallel_info,
+                  text_vec.size() - 2, s.number_of_runs, runner);
+    }
+
+    if (s.matches("parallel-pss-array32")) {
+      output_array<uint32_t> array(text_vec.size());
+      auto runner = [&]() {
+        xss::parallel::pss_array(text_vec.data(), array.data(),
+                                 text_vec.size(), s.threads, threshold);
+      };
+      run_generic("parallel-pss-array32", parallel_info, text_vec.size() - 2,
+                  s.number_of_runs, runner);
+    }
+
     if (s.matches("lyndon-array32")) {
-      std::vector<uint32_t> array(text_vec.size());
+      output_array<uint32_t> array(text_vec.size());
       auto runner = [&]() {
-        xss::lyndon_array(text_vec.data(), array.data(), text_vec.size());
+        xss::lyndon_array(text_vec.data(), array.data(), text_vec.size(),
+                          threshold);
       };
-      run_generic("lyndon-array32", info, text_vec.size() - 2, s.number_of_runs,
-                  runner);
+      run_generic("lyndon-array32", threshold_info, text_vec.size() - 2,
+                  s.number_of_runs, runner);
     }
 
     if (s.matches("nss-array32")) {
-      std::vector<uint32_t> array(text_vec.size());
+      output_array<uint32_t> array(text_vec.size());
       auto runner = [&]() {
-        xss::nss_array(text_vec.data(), array.data(), text_vec.size());
+        xss::nss_array(text_vec.data(), array.data(), text_vec.size(),
+                       threshold);
       };
-      run_generic("nss-array32", info, text_vec.size() - 2, s.number_of_runs,
-                  runner);
+      run_generic("nss-array32", threshold_info, text_vec.size() - 2,
+                  s.number_of_runs, runner);
     }
 
     if (s.matches("pss-array32")) {
-      std::vector<uint32_t> array(text_vec.size());
+      output_array<uint32_t> array(text_vec.size());
       auto runner = [&]() {
-        xss::pss_array(text_vec.data(), array.data(), text_vec.size());
+        xss::pss_array(text_vec.data(), array.data(), text_vec.size(),
+                       threshold);
       };
-      run_generic("pss-array32", info, text_vec.size() - 2, s.number_of_runs,
-                  runner);
+      run_generic("pss-array32", threshold_info, text_vec.size() - 2,
+                  s.number_of_runs, runner);
     }
 
     if (s.matches("pss-and-lyndon-array32")) {
-      std::vector<uint32_t> array1(text_vec.size());
-      std::vector<uint32_t> array2(text_vec.size());
+      output_array<uint32_t> array1(text_vec.size());
+      output_array<uint32_t> array2(text_vec.size());
       auto runner = [&]() {
-        xss::pss_and_lyndon_array(text_vec.data(), array1.data(), array2.data(),
-                                  text_vec.size());
+        xss::pss_and_lyndon_array(text_vec.data(), array1.data(),
+                                  array2.data(), text_vec.size(), threshold);
       };
-      run_generic("pss-and-lyndon-array32", info, text_vec.size() - 2,
-                  s.number_of_runs, runner);
+      run_generic("pss-and-lyndon-array32", threshold_info,
+                  text_vec.size() - 2, s.number_of_runs, runner);
     }
 
     if (s.matches("pss-and-nss-array32")) {
-      std::vector<uint32_t> array1(text_vec.size());
-      std::vector<uint32_t> array2(text_vec.size());
+      output_array<uint32_t> array1(text_vec.size());
+      output_array<uint32_t> array2(text_vec.size());
       auto runner = [&]() {
         xss::pss_and_nss_array(text_vec.data(), array1.data(), array2.data(),
-                               text_vec.size());
+                               text_vec.size(), threshold);
       };
-      run_generic("pss-and-nss-array32", info, text_vec.size() - 2,
+      run_generic("pss-and-nss-array32", threshold_info, text_vec.size() - 2,
                   s.number_of_runs, runner);
     }
 
-    if (s.matches("lyndon-isa-nsv32")) {
-      std::vector<uint32_t> array(text_vec.size() - 1);
+    // these algorithms only support 1-byte characters
+    if constexpr (byte_text) {
+      if (first && s.matches("lyndon-isa-nsv32")) {
+        std::vector<uint32_t> array(text_vec.size() - 1);
+        auto runner = [&]() {
+          lyndon_isa_nsv(&(text_vec.data()[1]), array.data(),
+                         text_vec.size() - 1);
+        };
+        run_generic("lyndon-isa-nsv32", info, text_vec.size() - 2,
+                    s.number_of_runs, runner);
+      }
+
+      if (first && s.matches("divsufsort32")) {
+        std::vector<int32_t> sa_vec(text_vec.size() - 1);
+        auto runner = [&]() {
+          divsufsort(&(text_vec.data()[1]), sa_vec.data(), text_vec.size() - 1);
+        };
+        auto teardown = [&]() {
+          sa_vec.resize(0);
+          sa_vec.resize(text_vec.size() - 1);
+        };
+        run_generic("divsufsort32", info, text_vec.size() - 2, s.number_of_runs,
+                    runner, teardown);
+      }
+    }
+
+    if (s.matches("parallel-lyndon-array64")) {
+      output_array<uint64_t> array(text_vec.size());
       auto runner = [&]() {
-        lyndon_isa_nsv(&(text_vec.data()[1]), array.data(),
-                       text_vec.size() - 1);
+        xss::parallel::lyndon_array(text_vec.data(), array.data(),
+                                    text_vec.size(), s.threads, threshold);
+      };
+      run_generic("parallel-lyndon-array64", parallel_info,
+                  text_vec.size() - 2, s.number_of_runs, runner);
+    }
+
+    if (s.matches("parallel-nss-array64")) {
+      output_array<uint64_t> array(text_vec.size());
+      auto runner = [&]() {
+        xss::parallel::nss_array(text_vec.data(), array.data(),
+                                 text_vec.size(), s.threads, threshold);
       };
-      run_generic("lyndon-isa-nsv32", info, text_vec.size() - 2,
+      run_generic("parallel-nss-array64", parallel_info, text_vec.size() - 2,
                   s.number_of_runs, runner);
     }
 
-    if (s.matches("divsufsort32")) {
-      std::vector<int32_t> sa_vec(text_vec.size() - 1);
+    if (s.matches("parallel-lyndon-array-by-factors64")) {
+      output_array<uint64_t> array(text_vec.size());
       auto runner = [&]() {
-        divsufsort(&(text_vec.data()[1]), sa_vec.data(), text_vec.size() - 1);
+        xss::parallel::lyndon_array_by_factors(text_vec.data(), array.data(),
+                                               text_vec.size(), s.threads,
+                                               threshold);
       };
-      auto teardown = [&]() {
-        sa_vec.resize(0);
-        sa_vec.resize(text_vec.size() - 1);
+      run_generic("parallel-lyndon-array-by-factors64", parallel_info,
+                  text_vec.size() - 2, s.number_of_runs, runner);
+    }
+
+    if (s.matches("parallel-nss-array-by-factors64")) {
+      output_array<uint64_t> array(text_vec.size());
+      auto runner = [&]() {
+        xss::parallel::nss_array_by_factors(text_vec.data(), array.data(),
+                                            text_vec.size(), s.threads,
+                                            threshold);
       };
-      run_generic("divsufsort32", info, text_vec.size() - 2, s.number_of_runs,
-                  runner, teardown);
+      run_generic("parallel-nss-array-by-factors64", parallel_info,
+                  text_vec.size() - 2, s.number_of_runs, runner);
+    }
+
+    if (s.matches("parallel-pss-array64")) {
+      output_array<uint64_t> array(text_vec.size());
+      auto runner = [&]() {
+        xss::parallel::pss_array(text_vec.data(), array.data(),
+                                 text_vec.size(), s.threads, threshold);
+      };
+      run_generic("parallel-pss-array64", parallel_info, text_vec.size() - 2,
+                  s.number_of_runs, runner);
     }
 
     if (s.matches("lyndon-array64")) {
-      std::vector<uint64_t> array(text_vec.size());
+      output_array<uint64_t> array(text_vec.size());
       auto runner = [&]() {
-        xss::lyndon_array(text_vec.data(), array.data(), text_vec.size());
+        xss::lyndon_array(text_vec.data(), array.data(), text_vec.size(),
+                          threshold);
       };
-      run_generic("lyndon-array64", info, text_vec.size() - 2, s.number_of_runs,
-                  runner);
+      run_generic("lyndon-array64", threshold_info, text_vec.size() - 2,
+                  s.number_of_runs, runner);
     }
 
     if (s.matches("nss-array64")) {
-      std::vector<uint64_t> array(text_vec.size());
+      output_array<uint64_t> array(text_vec.size());
       auto runner = [&]() {
-        xss::nss_array(text_vec.data(), array.data(), text_vec.size());
+        xss::nss_array(text_vec.data(), array.data(), text_vec.size(),
+                       threshold);
       };
-      run_generic("nss-array64", info, text_vec.size() - 2, s.number_of_runs,
-                  runner);
+      run_generic("nss-array64", threshold_info, text_vec.size() - 2,
+                  s.number_of_runs, runner);
     }
 
     if (s.matches("pss-array64")) {
-      std::vector<uint64_t> array(text_vec.size());
+      output_array<uint64_t> array(text_vec.size());
       auto runner = [&]() {
-        xss::pss_array(text_vec.data(), array.data(), text_vec.size());
+        xss::pss_array(text_vec.data(), array.data(), text_vec.size(),
+                       threshold);
       };
-      run_generic("pss-array64", info, text_vec.size() - 2, s.number_of_runs,
-                  runner);
+      run_generic("pss-array64", threshold_info, text_vec.size() - 2,
+                  s.number_of_runs, runner);
     }
 
     if (s.matches("pss-and-lyndon-array64")) {
-      std::vector<uint64_t> array1(text_vec.size());
-      std::vector<uint64_t> array2(text_vec.size());
+      output_array<uint64_t> array1(text_vec.size());
+      output_array<uint64_t> array2(text_vec.size());
       auto runner = [&]() {
-        xss::pss_and_lyndon_array(text_vec.data(), array1.data(), array2.data(),
-                                  text_vec.size());
+        xss::pss_and_lyndon_array(text_vec.data(), array1.data(),
+                                  array2.data(), text_vec.size(), threshold);
       };
-      run_generic("pss-and-lyndon-array64", info, text_vec.size() - 2,
-                  s.number_of_runs, runner);
+      run_generic("pss-and-lyndon-array64", threshold_info,
+                  text_vec.size() - 2, s.number_of_runs, runner);
     }
 
     if (s.matches("pss-and-nss-array64")) {
-      std::vector<uint64_t> array1(text_vec.size());
-      std::vector<uint64_t> array2(text_vec.size());
+      output_array<uint64_t> array1(text_vec.size());
+      output_array<uint64_t> array2(text_vec.size());
       auto runner = [&]() {
         xss::pss_and_nss_array(text_vec.data(), array1.data(), array2.data(),
-                               text_vec.size());
+                               text_vec.size(), threshold);
       };
-      run_generic("pss-and-nss-array64", info, text_vec.size() - 2,
+      run_generic("pss-and-nss-array64", threshold_info, text_vec.size() - 2,
                   s.number_of_runs, runner);
     }
 
-    if (s.matches("lyndon-isa-nsv64")) {
-      std::vector<uint64_t> array(text_vec.size() - 1);
-      auto runner = [&]() {
-        lyndon_isa_nsv(&(text_vec.data()[1]), array.data(),
+    // these algorithms only support 1-byte characters
+    if constexpr (byte_text) {
+      if (first && s.matches("lyndon-isa-nsv64")) {
+        std::vector<uint64_t> array(text_vec.size() - 1);
+        auto runner = [&]() {
+          lyndon_isa_nsv(&(text_vec.data()[1]), array.data(),
+                         text_vec.size() - 1);
+        };
+        run_generic("lyndon-isa-nsv64", info, text_vec.size() - 2,
+                    s.number_of_runs, runner);
+      }
+
+      if (first && s.matches("divsufsort64")) {
+        std::vector<int64_t> sa_vec(text_vec.size() - 1);
+        auto runner = [&]() {
+          divsufsort64(&(text_vec.data()[1]), sa_vec.data(),
                        text_vec.size() - 1);
-      };
-      run_generic("lyndon-isa-nsv64", info, text_vec.size() - 2,
-                  s.number_of_runs, runner);
+        };
+        auto teardown = [&]() {
+          sa_vec.resize(0);
+          sa_vec.resize(text_vec.size() - 1);
+        };
+        run_generic("divsufsort64", info, text_vec.size() - 2, s.number_of_runs,
+                    runner, teardown);
+      }
     }
+  }
+}
 
-    if (s.matches("divsufsort64")) {
-      std::vector<int64_t> sa_vec(text_vec.size() - 1);
-      auto runner = [&]() {
-        divsufsort64(&(text_vec.data()[1]), sa_vec.data(), text_vec.size() - 1);
-      };
-      auto teardown = [&]() {
-        sa_vec.resize(0);
-        sa_vec.resize(text_vec.size() - 1);
-      };
-      run_generic("divsufsort64", info, text_vec.size() - 2, s.number_of_runs,
-                  runner, teardown);
+int main(int argc, char const* argv[]) {
+  tlx::CmdlineParser cp;
+  cp.set_description("Nearest Smaller Suffix Construction");
+  cp.set_author("Jonas Ellert <jonas.ellert@tu-dortmund.de>");
+
+  cp.add_stringlist('f', "file", s.file_paths, "Path(s) to the text file(s).");
+  cp.add_stringlist('g', "generate", s.families,
+                    "Generate synthetic text(s) of length -l instead of "
+                    "reading files (see --list for the families).");
+  cp.add_bytes('\0', "seed", s.seed,
+               "Seed of the randomized text families (default = 0).");
+
+  cp.add_bytes('r', "runs", s.number_of_runs,
+               "Number of repetitions of the algorithm (default = 5).");
+  cp.add_bytes('w', "warmup", run_config.warmup_runs,
+               "Number of unmeasured runs before the measured runs of each "
+               "algorithm (default = 0).");
+  cp.add_bytes('l', "length", s.prefix_size,
+               "Length of the prefix of the text that should be considered.");
+
+  cp.add_bytes('b', "bytes-per-char", s.bytes_per_char,
+               "Number of bytes per character (1, 2 or 4, default = 1). Wider "
+               "characters are read as binary little-endian integers.");
+
+  cp.add_flag('\0', "mmap", s.mmap,
+              "Map the text into memory instead of reading it (only for 1-byte "
+              "characters, and only if the text does not contain "
+              "null-characters).");
+  cp.add_flag('\0', "populate", s.populate,
+              "Pre-fault the mapped text (only together with --mmap).");
+  cp.add_flag('\0', "sequential", s.sequential,
+              "Advise the kernel to read the mapped text ahead and to drop "
+              "pages soon after reading them (only together with --mmap). The "
+              "algorithms compare suffixes with earlier text, which may then "
+              "be read from the file again.");
+
+  cp.add_string('\0', "threshold", s.thresholds,
+                "Threshold(s) of the xss algorithms (comma separated, "
+                "default = 128). Each threshold is benchmarked separately.");
+  cp.add_flag('\0', "auto-threshold", s.auto_threshold,
+              "Additionally benchmark the threshold that is chosen "
+              "automatically for each text.");
+
+  cp.add_bytes('t', "threads", s.threads,
+               "Number of threads of the parallel-* algorithms (default = "
+               "number of hardware threads).");
+
+  cp.add_string('\0', "contains", s.contains,
+                "Only execute algorithms that contain at least one of the "
+                "given strings (comma separated).");
+  cp.add_string('\0', "not-contains", s.not_contains,
+                "Only execute algorithms that contain none of the given "
+                "strings (comma separated).");
+
+  cp.add_string('\0', "csv", run_config.csv_file,
+                "Append each measured run to the given CSV file.");
+  cp.add_string('\0', "json", run_config.json_file,
+                "Append each measured run to the given file (one JSON object "
+                "per line).");
+
+  cp.add_flag('\0', "perf", run_config.perf,
+              "Measure hardware counters (cycles, instructions, cache, branch "
+              "and dTLB misses per character) with perf_event_open.");
+
+  cp.add_string('\0', "pages", s.pages,
+                "Pages of the outputs of the xss algorithms: standard, thp "
+                "(transparent huge pages), 2m or 1g (reserved huge pages, "
+                "default = standard).");
+  cp.add_string('\0', "numa", s.numa,
+                "NUMA placement of the outputs of the xss algorithms: "
+                "first-touch, local or interleave (default = first-touch).");
+
+  cp.add_flag('\0', "list", s.list, "List the available algorithms.");
+
+  if (!cp.process(argc, argv)) {
+    return -1;
+  }
+
+  if (s.bytes_per_char != 1 && s.bytes_per_char != 2 &&
+      s.bytes_per_char != 4) {
+    std::cerr << "Unsupported number of bytes per character: "
+              << s.bytes_per_char << std::endl;
+    return -1;
+  }
+
+  const std::vector<xss::page_size> page_sizes = {
+      xss::page_size::standard, xss::page_size::transparent,
+      xss::page_size::huge_2m, xss::page_size::huge_1g};
+  const std::vector<xss::numa_placement> placements = {
+      xss::numa_placement::first_touch, xss::numa_placement::local,
+      xss::numa_placement::interleave};
+  auto page_size = std::find_if(
+      page_sizes.begin(), page_sizes.end(),
+      [](const auto pages) { return xss::to_string(pages) == s.pages; });
+  auto placement = std::find_if(
+      placements.begin(), placements.end(),
+      [](const auto numa) { return xss::to_string(numa) == s.numa; });
+  if (page_size == page_sizes.end() || placement == placements.end()) {
+    std::cerr << "Unsupported pages or NUMA placement: " << s.pages << ", "
+              << s.numa << std::endl;
+    return -1;
+  }
+  s.output_memory.pages = *page_size;
+  s.output_memory.numa = *placement;
+  if (s.threads == 0)
+    s.threads = std::max(1U, std::thread::hardware_concurrency());
+
+  if (s.list) {
+    std::cout << "Available algorithms:" << std::endl;
+    std::cout << "    "
+              << "lyndon-array" << std::endl;
+    std::cout << "    "
+              << "nss-array" << std::endl;
+    std::cout << "    "
+              << "pss-array" << std::endl;
+    std::cout << "    "
+              << "pss-and-lyndon-array" << std::endl;
+    std::cout << "    "
+              << "pss-and-nss-array" << std::endl;
+    std::cout << "    "
+              << "parallel-lyndon-array" << std::endl;
+    std::cout << "    "
+              << "parallel-nss-array" << std::endl;
+    std::cout << "    "
+              << "parallel-pss-array" << std::endl;
+    std::cout << "    "
+              << "parallel-lyndon-array-by-factors" << std::endl;
+    std::cout << "    "
+              << "parallel-nss-array-by-factors" << std::endl;
+    std::cout << "    "
+              << "pss-tree" << std::endl;
+    std::cout << "    "
+              << "pss-tree-contiguous" << std::endl;
+    std::cout << "    "
+              << "parallel-pss-tree" << std::endl;
+    std::cout << "    "
+              << "pss-tree-arena" << std::endl;
+    std::cout << "    "
+              << "pss-tree-support-xss" << std::endl;
+    std::cout << "    "
+              << "pss-tree-support-fused" << std::endl;
+    std::cout << "    "
+              << "pss-tree-sliding" << std::endl;
+    std::cout << "    "
+              << "divsufsort" << std::endl;
+    std::cout << "Available text families (--generate):" << std::endl;
+    for (const auto& family : generator_families())
+      std::cout << "    " << family << std::endl;
+    return 0;
+  }
+
+  if (s.families.size() > 0 && s.prefix_size == 0) {
+    std::cerr << "The length of generated texts must be given with -l."
+              << std::endl;
+    return -1;
+  }
+
+  for (auto family : s.families) {
+    uint64_t sigma = 0;
+    const std::string source =
+        "generate=" + family + " seed=" + std::to_string(s.seed);
+    if (s.bytes_per_char == 2) {
+      text_instance<uint16_t> text_vec;
+      text_vec.copy = generated_instance<uint16_t>(family, s.prefix_size,
+                                                   s.seed, sigma);
+      benchmark_text(source, text_vec, sigma);
+    } else if (s.bytes_per_char == 4) {
+      text_instance<uint32_t> text_vec;
+      text_vec.copy = generated_instance<uint32_t>(family, s.prefix_size,
+                                                   s.seed, sigma);
+      benchmark_text(source, text_vec, sigma);
+    } else {
+      text_instance<> text_vec;
+      text_vec.copy = generated_instance(family, s.prefix_size, s.seed, sigma);
+      benchmark_text(source, text_vec, sigma);
+    }
+  }
+
+  for (auto file : s.file_paths) {
+    uint64_t sigma = 0;
+    if (s.bytes_per_char == 2) {
+      text_instance<uint16_t> text_vec;
+      text_vec.copy = file_to_instance<uint16_t>(file, s.prefix_size, sigma);
+      benchmark_text("file=" + file, text_vec, sigma);
+    } else if (s.bytes_per_char == 4) {
+      text_instance<uint32_t> text_vec;
+      text_vec.copy = file_to_instance<uint32_t>(file, s.prefix_size, sigma);
+      benchmark_text("file=" + file, text_vec, sigma);
+    } else {
+      text_instance<> text_vec;
+      if (s.mmap)
+        text_vec = file_to_mapped_instance(file, s.prefix_size, s.populate,
+                                           s.sequential, sigma);
+      else
+        text_vec.copy = file_to_instance(file, s.prefix_size, sigma);
+      benchmark_text("file=" + file, text_vec, sigma);
     }
   }
 }
@@ -0,0 +1,75 @@
+//  Copyright (c) 2019 Jonas Ellert
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+
+
+#include <gtest/gtest.h>
+#include <xss.hpp>
+
+#include "util/random.hpp"
+
+struct anchor_context_type {
+  const uint8_t* text;
+  const xss::internal::lce_type<uint64_t, uint8_t> get_lce;
+};
+
+// the blockwise anchor must match the character-wise one for every LCE
+static void check_anchors(const std::vector<uint8_t>& text) {
+  const uint64_t n = text.size();
+  const anchor_context_type ctx{text.data(), {text.data(), n}};
+  for (uint64_t i = 1; i < n - 1; ++i) {
+    for (uint64_t lce = 1; i + lce < n; lce += 1 + (lce >> 3)) {
+      ASSERT_EQ(xss::internal::duval_anchor::get(ctx, i, lce),
+                xss::internal::blockwise_anchor::get(ctx, i, lce))
+          << "i=" << i << " lce=" << lce;
+    }
+  }
+}
+
+TEST(anchor, random) {
+  auto rng = random_number_generator<uint64_t>();
+  for (uint64_t sigma : {1, 2, 3}) {
+    std::vector<uint8_t> text(1000);
+    for (auto& c : text)
+      c = (rng() % sigma) + 1;
+    text[0] = text[text.size() - 1] = 0;
+    check_anchors(text);
+  }
+}
+
+TEST(anchor, runs) {
+  auto rng = random_number_generator<uint64_t>();
+  for (uint64_t period : {1, 2, 5, 13, 40}) {
+    for (uint64_t variant = 0; variant < 4; ++variant) {
+      std::vector<uint8_t> word(period);
+      for (auto& c : word)
+        c = (rng() % 3) + 1;
+      std::vector<uint8_t> text(1, 0);
+      // runs of the word, interrupted by random characters
+      while (text.size() < 1500) {
+        for (uint64_t rep = rng() % 20; rep > 0; --rep)
+          text.insert(text.end(), word.begin(), word.end());
+        for (uint64_t k = rng() % (1 + variant * 3); k > 0; --k)
+          text.push_back((rng() % 3) + 1);
+      }
+      text.push_back(0);
+      check_anchors(text);
+    }
+  }
+}
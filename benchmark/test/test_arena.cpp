@@ -0,0 +1,152 @@
+//  Copyright (c) 2019 Jonas Ellert
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+
+
+#include <gtest/gtest.h>
+#include <xss.hpp>
+
+#include "strings/test_lookahead.hpp"
+#include "strings/test_manual.hpp"
+#include "strings/test_random.hpp"
+#include "strings/test_runs.hpp"
+#include "util/random.hpp"
+
+TEST(arena, lifo) {
+  constexpr uint64_t header = xss::arena::header_bytes;
+  xss::arena scratch(4096);
+  ASSERT_EQ(4096U, scratch.capacity());
+  void* a = scratch.allocate(100);
+  void* b = scratch.allocate(1000);
+  ASSERT_EQ(0U, ((uintptr_t) a) % xss::arena::alignment);
+  ASSERT_EQ(0U, ((uintptr_t) b) % xss::arena::alignment);
+  ASSERT_EQ(2 * header + 128U + 1024U, scratch.used());
+
+  // only the most recent allocation can be extended
+  ASSERT_FALSE(scratch.extend(a, 100, 200));
+  ASSERT_TRUE(scratch.extend(b, 1000, 2000));
+  ASSERT_EQ(2 * header + 128U + 2048U, scratch.used());
+
+  // an earlier allocation is given back together with the later ones
+  scratch.deallocate(a, 100);
+  ASSERT_EQ(2 * header + 128U + 2048U, scratch.used());
+  scratch.deallocate(b, 2000);
+  ASSERT_EQ(0U, scratch.used());
+  ASSERT_EQ(2 * header + 128U + 2048U, scratch.peak());
+
+  // allocations that do not fit are taken from the heap
+  void* c = scratch.allocate(8192);
+  ASSERT_EQ(0U, scratch.used());
+  ASSERT_EQ(8192U, scratch.overflow_bytes());
+  scratch.deallocate(c, 8192);
+
+  scratch.allocate(64);
+  scratch.reset();
+  ASSERT_EQ(0U, scratch.used());
+}
+
+TEST(arena, interleaved_stacks) {
+  // Two stacks that grow alternately cannot grow in place, so each one
+  // releases its previous block while the other one is more recent. These
+  // blocks are reclaimed when the stacks are destroyed.
+  xss::arena scratch(1 << 26, false);
+  {
+    contiguous_telescope_stack first(
+        contiguous_telescope_stack_words(nullptr, 0, &scratch));
+    contiguous_telescope_stack second(
+        contiguous_telescope_stack_words(nullptr, 0, &scratch));
+    for (uint64_t i = 1; i <= 100000; ++i) {
+      first.push(i * 200);
+      second.push(i * 300);
+    }
+    ASSERT_EQ(0U, scratch.overflow_bytes());
+    ASSERT_EQ(20000000U, first.top());
+    ASSERT_EQ(30000000U, second.top());
+  }
+  ASSERT_EQ(0U, scratch.used());
+  ASSERT_EQ(0U, scratch.overflow_bytes());
+}
+
+TEST(arena, failed_allocation) {
+  // an arena without memory hands out heap memory
+  xss::arena scratch(1ULL << 62);
+  ASSERT_EQ(0U, scratch.capacity());
+  void* a = scratch.allocate(100);
+  ASSERT_NE(nullptr, a);
+  ASSERT_EQ(128U, scratch.overflow_bytes());
+  scratch.deallocate(a, 100);
+}
+
+TEST(arena, telescope_stack) {
+  auto rng = random_number_generator(1, 256);
+  std::vector<uint64_t> buffer(1ULL << 16);
+  xss::arena scratch(buffer.data(), buffer.size() * sizeof(uint64_t));
+  {
+    // starts in 4 words and grows into the arena
+    std::vector<uint64_t> local(4);
+    contiguous_telescope_stack stack(
+        contiguous_telescope_stack_words(local.data(), 4, &scratch));
+    std::vector<uint64_t> elements = {0};
+    for (uint64_t i = 0; i < 20000; ++i) {
+      elements.push_back(elements.back() + rng());
+      stack.push(elements.back());
+    }
+    ASSERT_GT(scratch.used(), 0U);
+    ASSERT_EQ(0U, scratch.overflow_bytes());
+    for (uint64_t i = elements.size() - 1; i > 0; --i) {
+      ASSERT_EQ(elements[i], stack.top());
+      stack.pop();
+    }
+  }
+  ASSERT_EQ(0U, scratch.used());
+}
+
+TEST(arena, pss_tree) {
+  auto instances = get_instances_for_manual_test();
+  for (auto& t : get_instances_for_lookahead_test(64))
+    instances.push_back(std::move(t));
+  for (auto& t : get_instances_for_run_of_runs_test(100000))
+    instances.push_back(std::move(t));
+  for (auto& t : get_instances_for_random_test(16, 2, 4, 1000, 100000))
+    instances.push_back(std::move(t));
+
+  // one arena for all instances
+  uint64_t max_n = 0;
+  for (const auto& t : instances)
+    max_n = std::max(max_n, (uint64_t) t.size());
+  xss::arena scratch(xss::pss_tree_arena_bytes(max_n));
+  xss::arena tiny(1024);
+  for (const auto& t : instances) {
+    const uint64_t n = t.size();
+    // the stream may write one word beyond the result
+    const uint64_t words = (((n << 1) + 2 + 63) >> 6) + 1;
+    std::vector<uint64_t> expected(words), result(words), overflow(words);
+    xss::pss_tree(t.data(), expected.data(), n);
+    xss::pss_tree(scratch, t.data(), result.data(), n);
+    xss::pss_tree(tiny, t.data(), overflow.data(), n);
+    ASSERT_EQ(expected, result);
+    ASSERT_EQ(expected, overflow);
+    ASSERT_EQ(0U, scratch.used());
+    ASSERT_EQ(0U, tiny.used());
+  }
+  // the reverse stacks of these (short) instances fit into their budget
+  ASSERT_EQ(0U, scratch.overflow_bytes());
+  ASSERT_LE(scratch.peak(), xss::pss_tree_arena_bytes(max_n));
+  ASSERT_GT(tiny.overflow_bytes(), 0U);
+}
@@ -0,0 +1,87 @@
+//  Copyright (c) 2019 Jonas Ellert
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+
+
+#define XSS_STATISTICS
+
+#include <gtest/gtest.h>
+#include <xss.hpp>
+
+#include "util/random.hpp"
+
+TEST(auto_threshold, short_text) {
+  std::vector<uint8_t> text(1000, 'a');
+  text[0] = text.back() = 0;
+  ASSERT_EQ(xss::internal::DEFAULT_THRESHOLD,
+            xss::auto_threshold(text.data(), text.size()));
+}
+
+TEST(auto_threshold, long_text) {
+  auto rng = random_number_generator<uint64_t>();
+  const uint64_t n = xss::internal::AUTO_THRESHOLD_MIN_N;
+  std::vector<uint8_t> text(n);
+  for (uint64_t i = 1; i < n - 1; ++i)
+    text[i] = 'a' + (rng() % 4);
+  text[0] = text[n - 1] = 0;
+
+  // all candidates have the same cost on random texts, and the result only
+  // depends on the text
+  const uint64_t threshold = xss::auto_threshold(text.data(), n);
+  ASSERT_EQ(xss::internal::DEFAULT_THRESHOLD, threshold);
+  ASSERT_EQ(threshold, xss::auto_threshold(text.data(), n));
+
+  // the threshold does not affect the result
+  std::vector<uint32_t> expected(n), array(n);
+  xss::nss_array(text.data(), expected.data(), n);
+  xss::nss_array(text.data(), array.data(), n, threshold);
+  ASSERT_EQ(expected, array);
+}
+
+TEST(auto_threshold, run_outside_of_windows) {
+  // The windows are periodic (which favors large thresholds), and a long run
+  // lies between the first two windows. An unbounded threshold would need
+  // quadratic time for the run.
+  auto rng = random_number_generator<uint64_t>();
+  const uint64_t n = xss::internal::AUTO_THRESHOLD_MIN_N;
+  const uint64_t period = 3000;
+  std::vector<uint8_t> text(n);
+  for (uint64_t i = 1; i < n - 1; ++i)
+    text[i] = (i <= period) ? 'b' + (rng() % 4) : text[i - period];
+  std::fill(text.begin() + (n >> 4), text.begin() + (n >> 3), 'a');
+  text[0] = text[n - 1] = 0;
+
+  const uint64_t threshold = xss::auto_threshold(text.data(), n);
+  ASSERT_LE(threshold, 4096U);
+
+  // linear time: about as many compared characters as with the default
+  // threshold (a quadratic construction would compare about (n / 16)^2 / 2)
+  std::vector<uint32_t> expected(n), array(n);
+  xss::reset_statistics();
+  xss::nss_array(text.data(), expected.data(), n);
+  const uint64_t default_characters = xss::get_statistics().lce_characters;
+  xss::reset_statistics();
+  xss::nss_array(text.data(), array.data(), n, threshold);
+  const uint64_t auto_characters = xss::get_statistics().lce_characters;
+  ASSERT_EQ(expected, array);
+  std::cout << "threshold=" << threshold << ": " << auto_characters
+            << " compared characters (default: " << default_characters << ")"
+            << std::endl;
+  ASSERT_LE(auto_characters, 4 * default_characters + n);
+}
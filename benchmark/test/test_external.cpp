@@ -0,0 +1,75 @@
+//  Copyright (c) 2019 Jonas Ellert
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+
+
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <xss.hpp>
+
+#include "util/random.hpp"
+
+template <typename index_type>
+static std::vector<uint64_t> read_array(const std::string& file_name,
+                                        const uint64_t n) {
+  std::vector<index_type> result(n);
+  std::ifstream in(file_name, std::ios::binary);
+  in.read((char*) result.data(), n * sizeof(index_type));
+  EXPECT_EQ((int64_t)(n * sizeof(index_type)), (int64_t) in.gcount());
+  return std::vector<uint64_t>(result.begin(), result.end());
+}
+
+TEST(external, matches_internal) {
+  auto rng_char = random_number_generator<uint64_t>();
+  char in_buffer[] = "/tmp/xss_external_in_XXXXXX";
+  char out_buffer[] = "/tmp/xss_external_out_XXXXXX";
+  close(mkstemp(in_buffer));
+  close(mkstemp(out_buffer));
+  const std::string in_name = in_buffer;
+  const std::string out_name = out_buffer;
+
+  for (uint64_t length : {0UL, 1UL, 100UL, 5000UL, 300000UL}) {
+    // with and without null-characters (i.e. virtual sentinels)
+    for (uint64_t smallest : {0UL, 1UL}) {
+      std::vector<uint8_t> text(length);
+      for (auto& c : text)
+        c = (rng_char() % 3) + smallest;
+      {
+        std::ofstream out(in_name, std::ios::binary);
+        out.write((const char*) text.data(), length);
+      }
+
+      std::vector<uint64_t> nss(length + 2), pss(length + 2);
+      xss::nss_array(xss::without_sentinels, text.data(), nss.data(), length);
+      xss::pss_array(xss::without_sentinels, text.data(), pss.data(), length);
+
+      // the smallest budget forces tiny buffers
+      for (uint64_t budget : {1UL, 1UL << 20}) {
+        ASSERT_TRUE(xss::external::nss_array(in_name, out_name, budget));
+        ASSERT_EQ(nss, read_array<uint64_t>(out_name, length + 2));
+        ASSERT_TRUE(
+            xss::external::pss_array<uint32_t>(in_name, out_name, budget));
+        ASSERT_EQ(pss, read_array<uint32_t>(out_name, length + 2));
+      }
+    }
+  }
+  std::remove(in_name.c_str());
+  std::remove(out_name.c_str());
+}
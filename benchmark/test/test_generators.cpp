@@ -0,0 +1,77 @@
+//  Copyright (c) 2019 Jonas Ellert
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+
+
+#include <gtest/gtest.h>
+#include <xss.hpp>
+
+#include "../include/generators.hpp"
+#include "strings/test_overlap.hpp"
+#include "strings/test_runs.hpp"
+#include "util/check_array.hpp"
+
+TEST(generators, test_suite_families) {
+  for (uint64_t n : {2, 5, 100, 1000, 12345}) {
+    ASSERT_EQ(generate_test_high_overlap(n + 2),
+              generate_instance("overlap", n, 0));
+    for (uint64_t r : {2, 3, 16}) {
+      if (r > n)
+        continue;
+      ASSERT_EQ(generate_test_run_of_runs(n + 2, r),
+                generate_instance("run-of-runs:" + std::to_string(r), n, 0));
+    }
+  }
+}
+
+TEST(generators, words) {
+  auto as_string = [](const std::vector<uint8_t>& text) {
+    return std::string(text.begin() + 1, text.end() - 1);
+  };
+  EXPECT_EQ("abaababaabaababaababa",
+            as_string(generate_instance("fibonacci", 21, 0)));
+  EXPECT_EQ("abbabaabbaababbab",
+            as_string(generate_instance("thue-morse", 17, 0)));
+  EXPECT_EQ("abaaabababaaabaaa",
+            as_string(generate_instance("period-doubling", 17, 0)));
+  EXPECT_EQ(0U, generate_instance("unknown", 17, 0).size());
+}
+
+TEST(generators, sentinels_and_seeds) {
+  for (auto family : {"random", "random:2", "random:255", "fibonacci",
+                      "thue-morse", "period-doubling", "run-of-runs:5",
+                      "overlap", "lookahead", "lookahead:16"}) {
+    for (uint64_t n : {1, 2, 3, 64, 10000}) {
+      const auto text = generate_instance(family, n, 7);
+      ASSERT_EQ(n + 2, text.size());
+      ASSERT_EQ(0, text[0]);
+      ASSERT_EQ(0, text[n + 1]);
+      for (uint64_t i = 1; i <= n; ++i)
+        ASSERT_NE(0, text[i]) << family << " " << n << " " << i;
+      ASSERT_EQ(text, generate_instance(family, n, 7));
+
+      auto nss = xss::get<xss::NSS>(text.data(), text.size());
+      check_array<true, true>::check_nss(text, nss);
+    }
+  }
+  ASSERT_NE(generate_instance("random", 1000, 1),
+            generate_instance("random", 1000, 2));
+  const auto wide = generate_instance<uint16_t>("random:1000", 10000, 3);
+  ASSERT_GT(*std::max_element(wide.begin(), wide.end()), 255);
+}
@@ -0,0 +1,175 @@
+//  Copyright (c) 2019 Jonas Ellert
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+
+
+#include <gtest/gtest.h>
+#include <xss.hpp>
+
+#include "util/random.hpp"
+
+template <uint64_t fixed_width>
+static void check_access(const uint64_t bits) {
+  auto rng = random_number_generator<uint64_t>();
+  constexpr uint64_t size = 1000;
+  xss::int_vector<fixed_width> vector(size, bits);
+  std::vector<uint64_t> expected(size, 0);
+  const uint64_t mask =
+      (vector.width() < 64) ? ((1ULL << vector.width()) - 1) : ~0ULL;
+  for (uint64_t k = 0; k < 16 * size; ++k) {
+    const uint64_t idx = rng() % size;
+    expected[idx] = rng() & mask;
+    vector[idx] = expected[idx];
+  }
+  for (uint64_t idx = 0; idx < size; ++idx)
+    ASSERT_EQ(expected[idx], (uint64_t) vector[idx]);
+}
+
+TEST(int_vector, access) {
+  check_access<40>(0);
+  check_access<48>(0);
+  check_access<64>(0);
+  for (uint64_t bits = 1; bits <= 64; ++bits)
+    check_access<0>(bits);
+}
+
+template <typename int_vector_type>
+static void check_arrays(const std::vector<uint8_t>& text,
+                         int_vector_type& first,
+                         int_vector_type& second) {
+  const uint64_t n = text.size();
+  std::vector<uint64_t> expected_first(n), expected_second(n);
+  const auto check = [&](const auto& expected, const auto& actual) {
+    for (uint64_t i = 0; i < n; ++i)
+      ASSERT_EQ(expected[i], (uint64_t) actual[i]);
+  };
+
+  xss::pss_array(text.data(), expected_first.data(), n);
+  xss::pss_array(text.data(), first, n);
+  check(expected_first, first);
+
+  xss::nss_array(text.data(), expected_first.data(), n);
+  xss::nss_array(text.data(), first, n);
+  check(expected_first, first);
+
+  xss::lyndon_array(text.data(), expected_first.data(), n);
+  xss::lyndon_array(text.data(), first, n);
+  check(expected_first, first);
+
+  xss::pss_and_nss_array(text.data(), expected_first.data(),
+                         expected_second.data(), n);
+  xss::pss_and_nss_array(text.data(), first, second, n);
+  check(expected_first, first);
+  check(expected_second, second);
+
+  xss::pss_and_lyndon_array(text.data(), expected_first.data(),
+                            expected_second.data(), n);
+  xss::pss_and_lyndon_array(text.data(), first, second, n);
+  check(expected_first, first);
+  check(expected_second, second);
+}
+
+TEST(int_vector, arrays) {
+  auto rng = random_number_generator<uint64_t>();
+  for (uint64_t sigma : {1, 2, 4, 200}) {
+    for (uint64_t n : {3, 10, 1000, 100000}) {
+      std::vector<uint8_t> text(n);
+      for (uint64_t i = 1; i < n - 1; ++i)
+        text[i] = (rng() % sigma) + 1;
+      text[0] = text[n - 1] = 0;
+
+      xss::int_vector<40> first40(n), second40(n);
+      check_arrays(text, first40, second40);
+
+      const uint64_t bits = xss::int_vector<>::required_width(n);
+      xss::int_vector<> first(n, bits), second(n, bits);
+      check_arrays(text, first, second);
+    }
+  }
+}
+
+TEST(int_vector, undersized) {
+  auto rng = random_number_generator<uint64_t>();
+  const uint64_t n = 100000;
+  std::vector<uint8_t> text(n);
+  for (uint64_t i = 1; i < n - 1; ++i)
+    text[i] = (rng() % 4) + 1;
+  text[0] = text[n - 1] = 0;
+  std::vector<uint64_t> expected(n);
+  xss::nss_array(text.data(), expected.data(), n);
+
+  // too few entries and too few bits are replaced by a large enough vector
+  for (auto [size, bits] : std::vector<std::pair<uint64_t, uint64_t>>{
+           {10, 17}, {n, 3}, {0, 1}}) {
+    xss::int_vector<> nss(size, bits);
+    ASSERT_TRUE(xss::nss_array(text.data(), nss, n));
+    ASSERT_GE(nss.size(), n);
+    ASSERT_GE(nss.width(), xss::int_vector<>::required_width(n));
+    for (uint64_t i = 0; i < n; ++i)
+      ASSERT_EQ(expected[i], (uint64_t) nss[i]);
+  }
+
+  xss::int_vector<40> nss40(10);
+  ASSERT_TRUE(xss::nss_array(text.data(), nss40, n));
+  ASSERT_EQ(n, nss40.size());
+
+  // a fixed width that is too small cannot be replaced
+  xss::int_vector<16> pss16(n), lyndon16(n);
+  pss16[5] = 42;
+  ASSERT_FALSE(xss::pss_array(text.data(), pss16, n));
+  ASSERT_FALSE(xss::pss_and_lyndon_array(text.data(), pss16, lyndon16, n));
+  ASSERT_EQ(42U, (uint64_t) pss16[5]);
+}
+
+TEST(int_vector, periodic_scratch) {
+  // the scratch buffer of the packed arrays must not grow with the LCE
+  const uint64_t n = 1000000;
+  for (const std::string period : {"a", "ab", "ba", "bbbbbbba"}) {
+    std::vector<uint8_t> text(n);
+    for (uint64_t i = 1; i < n - 1; ++i)
+      text[i] = period[i % period.size()];
+    text[0] = text[n - 1] = 0;
+
+    const uint64_t bits = xss::int_vector<>::required_width(n);
+    xss::int_vector<> first(n, bits), second(n, bits);
+    using ctx_type = xss::internal::packed_array_context_type<uint8_t, 0>;
+
+    ctx_type nss_ctx(text.data(), first, nullptr, n);
+    xss::internal::run_nss_array(nss_ctx, xss::internal::DEFAULT_THRESHOLD);
+    ASSERT_LE(nss_ctx.buffer.size(), 2 * period.size());
+
+    ctx_type lyndon_ctx(text.data(), first, nullptr, n);
+    xss::internal::run_lyndon_array(lyndon_ctx,
+                                    xss::internal::DEFAULT_THRESHOLD);
+    ASSERT_LE(lyndon_ctx.buffer.size(), 2 * period.size());
+
+    ctx_type pss_ctx(text.data(), first, &second, n);
+    xss::internal::run_pss_and_x_array<true, false>(
+        pss_ctx, xss::internal::DEFAULT_THRESHOLD);
+    ASSERT_LE(pss_ctx.buffer.size(), 2 * period.size());
+
+    std::vector<uint64_t> expected_pss(n), expected_nss(n);
+    xss::pss_and_nss_array(text.data(), expected_pss.data(),
+                           expected_nss.data(), n);
+    for (uint64_t i = 0; i < n; ++i) {
+      ASSERT_EQ(expected_pss[i], (uint64_t) first[i]);
+      ASSERT_EQ(expected_nss[i], (uint64_t) second[i]);
+    }
+  }
+}
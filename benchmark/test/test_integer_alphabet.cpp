@@ -0,0 +1,130 @@
+//  Copyright (c) 2019 Jonas Ellert
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+
+
+#include <gtest/gtest.h>
+#include <xss.hpp>
+
+#include "util/check_array.hpp"
+#include "util/random.hpp"
+
+// The characters are shifted into the most significant byte, such that
+// blockwise comparisons have to detect mismatches in any byte of a character.
+template <typename value_type>
+static std::vector<value_type> widen(const std::vector<uint8_t>& text) {
+  std::vector<value_type> result(text.size());
+  for (uint64_t i = 0; i < text.size(); ++i)
+    result[i] = ((value_type) text[i]) << (8 * (sizeof(value_type) - 1));
+  return result;
+}
+
+static std::vector<uint8_t> random_text(const uint64_t n,
+                                        const uint64_t sigma) {
+  auto rng = random_number_generator<uint64_t>();
+  std::vector<uint8_t> text(n);
+  for (uint64_t i = 1; i < n - 1; ++i)
+    text[i] = (rng() % sigma) + 1;
+  text[0] = text[n - 1] = 0;
+  return text;
+}
+
+template <typename value_type>
+static void check_lce() {
+  for (uint64_t sigma : {1, 2, 4}) {
+    for (uint64_t n : {3, 17, 100, 1000}) {
+      const auto text = widen<value_type>(random_text(n, sigma));
+      const xss::internal::lce_type<uint64_t, value_type> lce{text.data(), n};
+      for (uint64_t l = 1; l < n - 1; ++l) {
+        for (uint64_t r = l + 1; r < n - 1; ++r) {
+          uint64_t expected = 0;
+          while (text[l + expected] == text[r + expected])
+            ++expected;
+          ASSERT_EQ(expected, lce.without_bounds(l, r));
+          ASSERT_EQ(expected, lce.without_bounds(r, l));
+          ASSERT_EQ(std::min(expected, r - l),
+                    lce.with_upper_bound(l, r, r - l));
+        }
+      }
+    }
+  }
+}
+
+TEST(integer_alphabet, lce) {
+  check_lce<uint16_t>();
+  check_lce<uint32_t>();
+}
+
+// order-isomorphic texts have the same arrays and trees
+template <typename value_type>
+static void check_same_as_bytes(const std::vector<uint8_t>& text) {
+  const uint64_t n = text.size();
+  const auto wide = widen<value_type>(text);
+  std::vector<uint32_t> expected(n), actual(n);
+
+  xss::pss_array(text.data(), expected.data(), n);
+  xss::pss_array(wide.data(), actual.data(), n);
+  ASSERT_EQ(expected, actual);
+  xss::nss_array(text.data(), expected.data(), n);
+  xss::nss_array(wide.data(), actual.data(), n);
+  ASSERT_EQ(expected, actual);
+  xss::lyndon_array(text.data(), expected.data(), n);
+  xss::lyndon_array(wide.data(), actual.data(), n);
+  ASSERT_EQ(expected, actual);
+
+  const uint64_t words = (2 * n + 2 + 63) / 64 + 1;
+  std::vector<uint64_t> expected_bps(words, 0), actual_bps(words, 0);
+  xss::pss_tree(text.data(), expected_bps.data(), n);
+  xss::pss_tree(wide.data(), actual_bps.data(), n);
+  ASSERT_EQ(expected_bps, actual_bps);
+}
+
+TEST(integer_alphabet, same_as_bytes) {
+  for (uint64_t sigma : {1, 2, 4, 200}) {
+    for (uint64_t n : {3, 100, 10000, 100000}) {
+      const auto text = random_text(n, sigma);
+      check_same_as_bytes<uint16_t>(text);
+      check_same_as_bytes<uint32_t>(text);
+    }
+  }
+  // long runs use the run extension and the lookahead
+  for (uint64_t period : {1, 3, 17, 200}) {
+    const auto word = random_text(period + 2, 3);
+    std::vector<uint8_t> text(1, 0);
+    for (uint64_t rep = 0; rep < 100000 / period; ++rep)
+      text.insert(text.end(), word.begin() + 1, word.end() - 1);
+    text.push_back(0);
+    check_same_as_bytes<uint16_t>(text);
+    check_same_as_bytes<uint32_t>(text);
+  }
+}
+
+TEST(integer_alphabet, large_alphabet) {
+  auto rng = random_number_generator<uint32_t>(1, (uint32_t) -1);
+  for (uint64_t n : {3, 1000, 100000}) {
+    std::vector<uint32_t> text(n);
+    for (uint64_t i = 1; i < n - 1; ++i)
+      text[i] = rng();
+    text[0] = text[n - 1] = 0;
+    std::vector<uint64_t> pss(n), nss(n);
+    xss::pss_and_nss_array(text.data(), pss.data(), nss.data(), n);
+    check_array<>::check_pss(text, pss);
+    check_array<>::check_nss(text, nss);
+  }
+}
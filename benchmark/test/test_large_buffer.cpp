@@ -0,0 +1,94 @@
+//  Copyright (c) 2019 Jonas Ellert
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+
+
+#include <gtest/gtest.h>
+#include <xss.hpp>
+
+#include "strings/test_random.hpp"
+#include "strings/test_runs.hpp"
+
+static std::vector<xss::memory_options> all_memory_options() {
+  std::vector<xss::memory_options> result;
+  for (auto pages : {xss::page_size::standard, xss::page_size::transparent,
+                     xss::page_size::huge_2m, xss::page_size::huge_1g})
+    for (auto numa : {xss::numa_placement::first_touch,
+                      xss::numa_placement::local,
+                      xss::numa_placement::interleave})
+      result.push_back({pages, numa, true});
+  return result;
+}
+
+TEST(large_buffer, allocation) {
+  for (const auto& options : all_memory_options()) {
+    // falls back to smaller pages and first touch if necessary
+    xss::large_buffer buffer(3 * 1000 * 1000 + 1, options);
+    ASSERT_TRUE((bool) buffer);
+    ASSERT_GE(buffer.size(), 3U * 1000 * 1000 + 1);
+    ASSERT_EQ(0U, ((uintptr_t) buffer.data()) % 4096);
+    if (buffer.pages() != xss::page_size::standard) {
+      ASSERT_EQ(0U, ((uintptr_t) buffer.data()) % (1ULL << 21));
+    }
+
+    uint64_t* const words = buffer.data<uint64_t>();
+    const uint64_t n = buffer.size() / sizeof(uint64_t);
+    for (uint64_t i = 0; i < n; i += 97)
+      ASSERT_EQ(0U, words[i]);
+    for (uint64_t i = 0; i < n; ++i)
+      words[i] = i;
+
+    xss::large_buffer moved(std::move(buffer));
+    ASSERT_FALSE((bool) buffer);
+    ASSERT_EQ(words, moved.data<uint64_t>());
+    ASSERT_EQ(n - 1, words[n - 1]);
+  }
+  ASSERT_FALSE((bool) xss::large_buffer(0));
+}
+
+TEST(large_buffer, outputs) {
+  auto instances = get_instances_for_run_of_runs_test(100000);
+  for (auto& t : get_instances_for_random_test(4, 2, 4, 1000, 100000))
+    instances.push_back(std::move(t));
+
+  const auto options = all_memory_options();
+  for (const auto& t : instances) {
+    const uint64_t n = t.size();
+    std::vector<uint32_t> expected_array(n);
+    xss::pss_array(t.data(), expected_array.data(), n);
+    xss::bit_vector expected_tree((n << 1) + 2);
+    xss::pss_tree(t.data(), expected_tree.data(), n);
+    const uint64_t words = (((n << 1) + 2 + 63) >> 6);
+
+    for (uint64_t o = 0; o < options.size(); o += 5) {
+      xss::large_buffer array(n * sizeof(uint32_t), options[o]);
+      xss::pss_array(t.data(), array.data<uint32_t>(), n);
+      ASSERT_TRUE(std::equal(expected_array.begin(), expected_array.end(),
+                             array.data<uint32_t>()));
+
+      // move assignment replaces the memory (as in the teardown of the
+      // benchmark)
+      xss::bit_vector tree(64);
+      tree = xss::bit_vector((n << 1) + 2, options[o]);
+      xss::pss_tree(t.data(), tree.data(), n);
+      ASSERT_TRUE(std::equal(expected_tree.data(),
+                             expected_tree.data() + words, tree.data()));
+    }
+  }
+}
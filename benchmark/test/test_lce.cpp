@@ -0,0 +1,66 @@
+//  Copyright (c) 2019 Jonas Ellert
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+
+
+#include <gtest/gtest.h>
+#include <xss.hpp>
+
+#include "util/random.hpp"
+
+static uint64_t naive_lce(const std::vector<uint8_t>& text,
+                          uint64_t l,
+                          uint64_t r,
+                          uint64_t lower,
+                          uint64_t upper) {
+  while (lower < upper && r + lower < text.size() &&
+         text[l + lower] == text[r + lower])
+    ++lower;
+  return lower;
+}
+
+TEST(lce, blocks_respect_bounds) {
+  auto rng_char = random_number_generator<uint64_t>();
+  for (uint64_t sigma : {1, 2, 4}) {
+    for (uint64_t n : {3, 17, 100, 1000}) {
+      std::vector<uint8_t> text(n);
+      for (uint64_t i = 1; i < n - 1; ++i)
+        text[i] = (rng_char() % sigma) + 1;
+      text[0] = text[n - 1] = 0;
+
+      const xss::internal::lce_type<uint64_t, uint8_t> lce{text.data(), n};
+      for (uint64_t l = 1; l < n - 1; ++l) {
+        for (uint64_t r = l + 1; r < n - 1; ++r) {
+          const uint64_t expected = naive_lce(text, l, r, 0, n);
+          ASSERT_EQ(expected, lce.without_bounds(l, r));
+          ASSERT_EQ(expected, lce.without_bounds(r, l));
+          if (expected > 0) {
+            ASSERT_EQ(expected, lce.with_lower_bound(l, r, expected - 1));
+          }
+          for (uint64_t upper : {expected / 2, expected, expected + 70}) {
+            ASSERT_EQ(std::min(expected, upper),
+                      lce.with_upper_bound(l, r, upper));
+            ASSERT_EQ(std::min(expected, upper),
+                      lce.with_both_bounds(l, r, expected / 3, upper));
+          }
+        }
+      }
+    }
+  }
+}
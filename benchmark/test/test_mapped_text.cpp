@@ -0,0 +1,70 @@
+//  Copyright (c) 2019 Jonas Ellert
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+
+
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <xss.hpp>
+
+#include "util/random.hpp"
+
+TEST(mapped_text, virtual_sentinels) {
+  auto rng_char = random_number_generator<uint64_t>();
+  char file_name_buffer[] = "/tmp/xss_mapped_text_XXXXXX";
+  close(mkstemp(file_name_buffer));
+  const std::string file_name = file_name_buffer;
+  const uint64_t page = sysconf(_SC_PAGESIZE);
+
+  for (uint64_t length :
+       {0UL, 1UL, 100UL, page - 1, page, page + 1, 3 * page}) {
+    std::vector<uint8_t> text(length + 2);
+    for (uint64_t i = 1; i <= length; ++i)
+      text[i] = (rng_char() % 4) + 1;
+    {
+      std::ofstream out(file_name, std::ios::binary);
+      out.write((const char*) &(text[1]), length);
+    }
+
+    for (uint64_t prefix : {0UL, 50UL, page}) {
+      const uint64_t n = ((prefix > 0) ? std::min(prefix, length) : length) + 2;
+      std::vector<uint8_t> expected(text.begin(), text.begin() + n);
+      expected[n - 1] = 0;
+
+      xss::mapped_text mapped(file_name, prefix, true);
+      ASSERT_TRUE((bool) mapped);
+      ASSERT_EQ(n, mapped.size());
+      ASSERT_FALSE(mapped.contains_null());
+      ASSERT_TRUE(std::equal(expected.begin(), expected.end(), mapped.data()));
+
+      std::vector<uint32_t> from_mapped(n), from_vector(n);
+      xss::nss_array(mapped.data(), from_mapped.data(), n);
+      xss::nss_array(expected.data(), from_vector.data(), n);
+      ASSERT_EQ(from_vector, from_mapped);
+    }
+  }
+
+  {
+    std::ofstream out(file_name, std::ios::binary);
+    out.put('a').put('\0').put('b');
+  }
+  ASSERT_TRUE(xss::mapped_text(file_name).contains_null());
+  std::remove(file_name.c_str());
+}
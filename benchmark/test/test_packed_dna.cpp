@@ -0,0 +1,82 @@
+//  Copyright (c) 2019 Jonas Ellert
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+
+
+#include <gtest/gtest.h>
+#include <xss.hpp>
+
+#include "util/random.hpp"
+
+// compares the packed overloads with the sentinel-free overloads on the
+// unpacked text (ASCII preserves the order A < C < G < T)
+static void check_packed(const std::vector<uint8_t>& text) {
+  const uint64_t n = text.size();
+  const auto packed = xss::pack_dna(text.data(), n);
+
+  std::vector<uint32_t> expected(n + 2), actual(n + 2);
+  xss::pss_array(xss::without_sentinels, text.data(), expected.data(), n);
+  xss::pss_array(xss::packed_dna, packed.data(), actual.data(), n);
+  ASSERT_EQ(expected, actual);
+
+  xss::nss_array(xss::without_sentinels, text.data(), expected.data(), n);
+  xss::nss_array(xss::packed_dna, packed.data(), actual.data(), n);
+  ASSERT_EQ(expected, actual);
+
+  xss::lyndon_array(xss::without_sentinels, text.data(), expected.data(), n);
+  xss::lyndon_array(xss::packed_dna, packed.data(), actual.data(), n);
+  ASSERT_EQ(expected, actual);
+
+  // one extra word, since the tree may flush one word too many
+  const uint64_t words = (2 * (n + 2) + 2 + 63) / 64 + 1;
+  std::vector<uint64_t> expected_bps(words, 0), actual_bps(words, 0);
+  xss::pss_tree(xss::without_sentinels, text.data(), expected_bps.data(), n);
+  xss::pss_tree(xss::packed_dna, packed.data(), actual_bps.data(), n);
+  ASSERT_EQ(expected_bps, actual_bps);
+}
+
+static const char bases[] = {'A', 'C', 'G', 'T'};
+
+TEST(packed_dna, random) {
+  auto rng = random_number_generator<uint64_t>();
+  for (uint64_t sigma : {1, 2, 4}) {
+    for (uint64_t n : {1, 2, 31, 32, 33, 64, 100, 1000, 100000}) {
+      std::vector<uint8_t> text(n);
+      for (auto& c : text)
+        c = bases[rng() % sigma];
+      check_packed(text);
+    }
+  }
+}
+
+TEST(packed_dna, runs) {
+  auto rng = random_number_generator<uint64_t>();
+  for (uint64_t period : {1, 3, 17, 32, 200}) {
+    std::vector<uint8_t> text;
+    std::vector<uint8_t> word(period);
+    for (auto& c : word)
+      c = bases[rng() % 4];
+    for (uint64_t rep = 0; rep < 100000 / period; ++rep)
+      text.insert(text.end(), word.begin(), word.end());
+    text.push_back(bases[rng() % 4]);
+    check_packed(text);
+    text.insert(text.begin(), 'A');
+    check_packed(text);
+  }
+}
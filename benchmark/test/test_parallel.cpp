@@ -0,0 +1,231 @@
+//  Copyright (c) 2019 Jonas Ellert
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+
+#include <gtest/gtest.h>
+#include <xss.hpp>
+
+#include "strings/test_lookahead.hpp"
+#include "strings/test_manual.hpp"
+#include "strings/test_overlap.hpp"
+#include "strings/test_random.hpp"
+#include "strings/test_runs.hpp"
+
+constexpr static uint64_t test_threads = 4;
+
+// compares the parallel arrays with the sequential ones for different numbers
+// of blocks (including tiny blocks that force many merges)
+template <typename instance_collection>
+static void parallel_instance_tests(instance_collection&& instances) {
+  std::cout << "Number of instances: " << instances.size() << std::endl;
+  for (auto& t : instances) {
+    const uint64_t n = t.size();
+    if (n < 3)
+      continue;
+
+    std::vector<uint32_t> expected(n), result(n);
+    for (uint64_t blocks : std::vector<uint64_t>{2, 3, 7, 64, n / 4 + 1, n}) {
+      xss::pss_array(t.data(), expected.data(), n);
+      xss::internal::parallel_array<false, false>(
+          t.data(), result.data(), n, blocks, test_threads,
+          xss::internal::DEFAULT_THRESHOLD);
+      ASSERT_EQ(expected, result) << "PSS, n=" << n << ", blocks=" << blocks;
+
+      xss::nss_array(t.data(), expected.data(), n);
+      xss::internal::parallel_array<true, false>(
+          t.data(), result.data(), n, blocks, test_threads,
+          xss::internal::DEFAULT_THRESHOLD);
+      ASSERT_EQ(expected, result) << "NSS, n=" << n << ", blocks=" << blocks;
+
+      xss::lyndon_array(t.data(), expected.data(), n);
+      xss::internal::parallel_array<false, true>(
+          t.data(), result.data(), n, blocks, test_threads,
+          xss::internal::DEFAULT_THRESHOLD);
+      ASSERT_EQ(expected, result) << "LYN, n=" << n << ", blocks=" << blocks;
+    }
+  }
+}
+
+// compares the parallel tree with the sequential one for different numbers of
+// blocks
+template <typename instance_collection>
+static void tree_instance_tests(instance_collection&& instances) {
+  std::cout << "Number of instances: " << instances.size() << std::endl;
+  for (auto& t : instances) {
+    const uint64_t n = t.size();
+    if (n < 3)
+      continue;
+
+    // the sequential algorithm may write one additional word
+    const uint64_t words = ((n << 1) + 2 + 63) >> 6;
+    std::vector<uint64_t> expected(words + 1), result(words + 1);
+    xss::pss_tree(t.data(), expected.data(), n);
+    expected[words] = result[words] = 0;
+    for (uint64_t blocks : std::vector<uint64_t>{2, 3, 7, 64, n / 4 + 1, n}) {
+      std::fill(result.begin(), result.begin() + words, ~0ULL);
+      xss::internal::parallel_pss_tree<uint32_t>(
+          t.data(), result.data(), n, blocks, test_threads,
+          xss::internal::DEFAULT_THRESHOLD);
+      ASSERT_EQ(expected, result) << "n=" << n << ", blocks=" << blocks;
+    }
+  }
+}
+
+// compares the factor parallel arrays with the sequential ones for different
+// chunk sizes
+template <typename instance_collection>
+static void factor_instance_tests(instance_collection&& instances) {
+  std::cout << "Number of instances: " << instances.size() << std::endl;
+  for (auto& t : instances) {
+    const uint64_t n = t.size();
+    if (n < 3)
+      continue;
+
+    std::vector<uint32_t> expected(n), result(n);
+    for (uint64_t chunk_size : std::vector<uint64_t>{1, 7, 100, n / 3}) {
+      xss::nss_array(t.data(), expected.data(), n);
+      xss::internal::factor_parallel_array<false>(
+          t.data(), result.data(), n, chunk_size, test_threads,
+          xss::internal::DEFAULT_THRESHOLD);
+      ASSERT_EQ(expected, result) << "NSS, n=" << n << ", chunk=" << chunk_size;
+
+      xss::lyndon_array(t.data(), expected.data(), n);
+      xss::internal::factor_parallel_array<true>(
+          t.data(), result.data(), n, chunk_size, test_threads,
+          xss::internal::DEFAULT_THRESHOLD);
+      ASSERT_EQ(expected, result) << "LYN, n=" << n << ", chunk=" << chunk_size;
+    }
+  }
+}
+
+// concatenation of random records in decreasing lexicographical order (many
+// Lyndon factors of varying length)
+static std::vector<vec_type> get_instances_for_factor_test(
+    const uint64_t instances, const uint64_t records, const uint64_t max_len) {
+  auto rng_len = random_number_generator<uint64_t>(1, max_len);
+  auto rng_char = random_number_generator<uint64_t>();
+  std::vector<vec_type> result(instances);
+  for (auto& instance : result) {
+    std::vector<vec_type> parts(records);
+    for (auto& part : parts) {
+      part.resize(rng_len());
+      for (auto& c : part)
+        c = (rng_char() % 4) + 'a';
+    }
+    std::sort(parts.begin(), parts.end(), std::greater<vec_type>());
+    instance.push_back(test_gen_sentinel);
+    for (auto& part : parts)
+      instance.insert(instance.end(), part.begin(), part.end());
+    instance.push_back(test_gen_sentinel);
+  }
+  return result;
+}
+
+TEST(parallel, factors) {
+  std::cout << "Lyndon factorization matches Duval's algorithm." << std::endl;
+  for (auto& t : get_instances_for_random_test(256, 2, 4, 16, 4095)) {
+    std::vector<uint64_t> expected, result;
+    const uint64_t n = t.size();
+    for (uint64_t i = 1; i < n - 1;) {
+      uint64_t j = i + 1, k = i;
+      while (t[k] <= t[j]) {
+        k = (t[k] < t[j]) ? i : k + 1;
+        ++j;
+      }
+      for (; i <= k; i += j - k)
+        expected.push_back(i);
+    }
+    xss::internal::lyndon_factorization(
+        t.data(), n, [&](uint64_t i) { result.push_back(i); });
+    ASSERT_EQ(expected, result);
+  }
+
+  factor_instance_tests(get_instances_for_manual_test());
+  factor_instance_tests(get_instances_for_lookahead_test(512));
+  factor_instance_tests(get_instances_for_random_test(64, 2, 15, 16, 16383));
+  factor_instance_tests(get_instances_for_factor_test(64, 1000, 64));
+}
+
+TEST(parallel, hand_selected) {
+  parallel_instance_tests(get_instances_for_manual_test());
+}
+
+TEST(parallel, overlap) {
+  parallel_instance_tests(get_instances_for_overlap_test(16, 16, 65536));
+}
+
+TEST(parallel, lookahead) {
+  parallel_instance_tests(get_instances_for_lookahead_test(512));
+}
+
+TEST(parallel, runs) {
+  parallel_instance_tests(get_instances_for_run_of_runs_test(65536));
+}
+
+TEST(parallel, random) {
+  parallel_instance_tests(get_instances_for_random_test(256, 2, 15, 16, 16383));
+  parallel_instance_tests(
+      get_instances_for_random_test(256, 16, 255, 16, 16383));
+}
+
+TEST(parallel, tree) {
+  tree_instance_tests(get_instances_for_manual_test());
+  tree_instance_tests(get_instances_for_overlap_test(16, 16, 65536));
+  tree_instance_tests(get_instances_for_lookahead_test(512));
+  tree_instance_tests(get_instances_for_run_of_runs_test(65536));
+  tree_instance_tests(get_instances_for_random_test(256, 2, 15, 16, 16383));
+  tree_instance_tests(get_instances_for_random_test(256, 16, 255, 16, 16383));
+}
+
+TEST(parallel, public_interface) {
+  auto instances = get_instances_for_random_test(4, 2, 4, 300000, 400000);
+  for (auto& t : instances) {
+    const uint64_t n = t.size();
+    std::vector<uint32_t> expected(n), result(n);
+    xss::pss_array(t.data(), expected.data(), n);
+    xss::parallel::pss_array(t.data(), result.data(), n, test_threads);
+    ASSERT_EQ(expected, result);
+    xss::nss_array(t.data(), expected.data(), n);
+    xss::parallel::nss_array(t.data(), result.data(), n, test_threads);
+    ASSERT_EQ(expected, result);
+    xss::lyndon_array(t.data(), expected.data(), n);
+    xss::parallel::lyndon_array(t.data(), result.data(), n, test_threads);
+    ASSERT_EQ(expected, result);
+
+    const uint64_t words = ((n << 1) + 2 + 63) >> 6;
+    std::vector<uint64_t> expected_bps(words + 1), result_bps(words + 1);
+    xss::pss_tree(t.data(), expected_bps.data(), n);
+    expected_bps[words] = 0;
+    xss::parallel::pss_tree(t.data(), result_bps.data(), n, test_threads);
+    ASSERT_EQ(expected_bps, result_bps);
+  }
+  instances = get_instances_for_factor_test(4, 20000, 64);
+  for (auto& t : instances) {
+    const uint64_t n = t.size();
+    std::vector<uint32_t> expected(n), result(n);
+    xss::nss_array(t.data(), expected.data(), n);
+    xss::parallel::nss_array_by_factors(t.data(), result.data(), n,
+                                        test_threads);
+    ASSERT_EQ(expected, result);
+    xss::lyndon_array(t.data(), expected.data(), n);
+    xss::parallel::lyndon_array_by_factors(t.data(), result.data(), n,
+                                           test_threads);
+    ASSERT_EQ(expected, result);
+  }
+}
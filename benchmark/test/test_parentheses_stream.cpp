@@ -0,0 +1,86 @@
+//  Copyright (c) 2019 Jonas Ellert
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+
+
+#include <gtest/gtest.h>
+#include <xss.hpp>
+
+#include "util/random.hpp"
+
+template <typename stream_type>
+static void append_bit(stream_type& stream, std::vector<bool>& expected,
+                       const bool bit) {
+  expected.push_back(bit);
+  if (bit)
+    stream.append_opening_parenthesis();
+  else
+    stream.append_closing_parenthesis();
+}
+
+// the copies (also overlapping ones) must match a bitwise copy
+TEST(parentheses_stream, append_copy) {
+  auto rng = random_number_generator<uint64_t>();
+  for (uint64_t test = 0; test < 5000; ++test) {
+    const uint64_t prefix = 1 + rng() % 300;
+    const uint64_t distance = 1 + rng() % prefix;
+    const uint64_t length = rng() % 700;
+    xss::bit_vector bv(prefix + length + 128, false);
+    std::vector<bool> expected;
+    {
+      xss::parentheses_stream stream(bv);
+      for (uint64_t k = 0; k < prefix; ++k)
+        append_bit(stream, expected, rng() & 1);
+      for (uint64_t k = 0; k < length; ++k)
+        expected.push_back(expected[expected.size() - distance]);
+      stream.append_copy(distance, length);
+      ASSERT_EQ(prefix + length, stream.bits_written());
+      for (uint64_t k = 0; k < 5; ++k)
+        append_bit(stream, expected, k & 1);
+    }
+    for (uint64_t k = 0; k < expected.size(); ++k)
+      ASSERT_EQ(expected[k], bv.get(k)) << k;
+  }
+}
+
+TEST(sliding_parentheses_stream, append_copy) {
+  auto rng = random_number_generator<uint64_t>();
+  for (uint64_t test = 0; test < 1000; ++test) {
+    const uint64_t prefix = 1 + rng() % 3000;
+    const uint64_t distance = 1 + rng() % std::min(prefix, (uint64_t) 4000);
+    const uint64_t length = rng() % 5000;
+    std::vector<uint64_t> words;
+    auto sink = [&](const uint64_t* w, const uint64_t count) {
+      words.insert(words.end(), w, w + count);
+    };
+    std::vector<bool> expected;
+    {
+      xss::sliding_parentheses_stream<decltype(sink)> stream(sink, 4096);
+      if (!stream.can_copy(distance))
+        continue;
+      for (uint64_t k = 0; k < prefix; ++k)
+        append_bit(stream, expected, rng() & 1);
+      for (uint64_t k = 0; k < length; ++k)
+        expected.push_back(expected[expected.size() - distance]);
+      stream.append_copy(distance, length);
+    }
+    for (uint64_t k = 0; k < expected.size(); ++k)
+      ASSERT_EQ(expected[k], (bool) ((words[k >> 6] >> (k & 63)) & 1)) << k;
+  }
+}
@@ -0,0 +1,185 @@
+//  Copyright (c) 2019 Jonas Ellert
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+
+
+#include <cstdio>
+#include <unistd.h>
+#include <gtest/gtest.h>
+#include <xss.hpp>
+
+#include "util/random.hpp"
+
+static std::vector<uint8_t> random_text(const uint64_t n) {
+  auto rng = random_number_generator<uint8_t>(1, 3);
+  std::vector<uint8_t> text(n);
+  for (uint64_t i = 1; i < n - 1; ++i)
+    text[i] = rng();
+  text[0] = text[n - 1] = 0;
+  return text;
+}
+
+static std::string temporary_file() {
+  char file_name_buffer[] = "/tmp/xss_serialization_XXXXXX";
+  close(mkstemp(file_name_buffer));
+  return file_name_buffer;
+}
+
+TEST(serialization, round_trip) {
+  const std::string file = temporary_file();
+  for (uint64_t n : {2, 3, 1000, 100000}) {
+    const auto text = random_text(n);
+    xss::bit_vector bps((n << 1) + 2);
+    xss::pss_tree(text.data(), bps.data(), n);
+    const xss::pss_tree_support support(bps);
+
+    for (bool with_support : {false, true}) {
+      ASSERT_TRUE(xss::save_pss_tree(file, bps, 32,
+                                     with_support ? &support : nullptr));
+      xss::mapped_pss_tree mapped(file, true);
+      ASSERT_TRUE((bool) mapped);
+      ASSERT_EQ(n, mapped.n());
+      ASSERT_EQ(32U, mapped.threshold());
+      ASSERT_EQ(with_support, mapped.has_support());
+      for (uint64_t i = 0; i < bps.size(); ++i)
+        ASSERT_EQ(bps.get(i), mapped.bps().get(i)) << i;
+
+      const auto loaded = mapped.support();
+      ASSERT_EQ(with_support, loaded.is_view());
+      for (uint64_t i = 0; i < n; ++i) {
+        ASSERT_EQ(support.pss(i), loaded.pss(i)) << i;
+        ASSERT_EQ(support.nss(i), loaded.nss(i)) << i;
+      }
+    }
+  }
+  std::remove(file.c_str());
+}
+
+TEST(serialization, view) {
+  const uint64_t n = 100000;
+  const auto text = random_text(n);
+  xss::bit_vector bps((n << 1) + 2);
+  xss::pss_tree(text.data(), bps.data(), n);
+  const xss::pss_tree_support support(bps);
+
+  // a view needs 64-byte alignment, otherwise the support is copied
+  const uint64_t bytes = support.serialized_bytes();
+  std::vector<uint64_t> buffer((bytes >> 3) + 16);
+  uint8_t* const aligned = (uint8_t*) ((((uintptr_t) buffer.data()) + 63) &
+                                       ~(uintptr_t) 63);
+  for (uint8_t* serialized : {aligned, aligned + 8}) {
+    support.serialize(serialized);
+    const xss::pss_tree_support loaded(bps.data(), bps.size(), serialized,
+                                       bytes,
+                                       xss::pss_tree_support::view_type());
+    ASSERT_EQ(serialized == aligned, loaded.is_view());
+    const xss::pss_tree_support copy = loaded;
+    ASSERT_EQ(loaded.is_view(), copy.is_view());
+    for (uint64_t i = 0; i < n; i += 3) {
+      ASSERT_EQ(support.pss(i), loaded.pss(i)) << i;
+      ASSERT_EQ(support.nss(i), copy.nss(i)) << i;
+    }
+  }
+}
+
+TEST(serialization, deterministic) {
+  const uint64_t n = 100000;
+  const auto text = random_text(n);
+  xss::bit_vector bps((n << 1) + 2);
+  xss::pss_tree(text.data(), bps.data(), n);
+
+  // the output does not depend on the memory of the support or the buffer
+  const xss::pss_tree_support support(bps);
+  std::vector<uint8_t> first(support.serialized_bytes(), 0x00);
+  support.serialize(first.data());
+  const xss::pss_tree_support other(bps);
+  std::vector<uint8_t> second(other.serialized_bytes(), 0xff);
+  other.serialize(second.data());
+  ASSERT_EQ(first, second);
+}
+
+TEST(serialization, invalid_files) {
+  const std::string file = temporary_file();
+  const uint64_t n = 1000;
+  const auto text = random_text(n);
+  xss::bit_vector bps((n << 1) + 2);
+  xss::pss_tree(text.data(), bps.data(), n);
+  ASSERT_TRUE(xss::save_pss_tree(file, bps));
+
+  // flip one bit of the BPS
+  FILE* f = std::fopen(file.c_str(), "r+b");
+  std::fseek(f, 64 + 8, SEEK_SET);
+  const int c = std::fgetc(f);
+  std::fseek(f, 64 + 8, SEEK_SET);
+  std::fputc(c ^ 1, f);
+  std::fclose(f);
+  ASSERT_TRUE((bool) xss::mapped_pss_tree(file));
+  ASSERT_FALSE((bool) xss::mapped_pss_tree(file, true));
+
+  // truncate the file
+  ASSERT_EQ(0, truncate(file.c_str(), 100));
+  ASSERT_FALSE((bool) xss::mapped_pss_tree(file));
+  std::remove(file.c_str());
+  ASSERT_FALSE((bool) xss::mapped_pss_tree(file));
+}
+
+TEST(serialization, corrupt_support) {
+  const std::string file = temporary_file();
+  const uint64_t n = 100000;
+  const auto text = random_text(n);
+  xss::bit_vector bps((n << 1) + 2);
+  xss::pss_tree(text.data(), bps.data(), n);
+  const xss::pss_tree_support support(bps);
+  const uint64_t support_offset = 64 + (((bps.size() + 511) >> 9) << 6);
+
+  // overwrite one of the counts in the header of the support
+  const auto corrupt = [&](const uint64_t count, const uint64_t value) {
+    ASSERT_TRUE(xss::save_pss_tree(file, bps, 128, &support));
+    FILE* f = std::fopen(file.c_str(), "r+b");
+    std::fseek(f, support_offset + count * sizeof(uint64_t), SEEK_SET);
+    std::fwrite(&value, sizeof(value), 1, f);
+    std::fclose(f);
+  };
+  for (uint64_t count = 0; count < 6; ++count) {
+    for (uint64_t value : {0ULL, 1ULL << 40, ~0ULL}) {
+      corrupt(count, value);
+      ASSERT_FALSE((bool) xss::mapped_pss_tree(file)) << count;
+    }
+  }
+
+  // the checksum covers the support
+  ASSERT_TRUE(xss::save_pss_tree(file, bps, 128, &support));
+  FILE* f = std::fopen(file.c_str(), "r+b");
+  std::fseek(f, support_offset + 64 + 8, SEEK_SET);
+  const int c = std::fgetc(f);
+  std::fseek(f, support_offset + 64 + 8, SEEK_SET);
+  std::fputc(c ^ 1, f);
+  std::fclose(f);
+  ASSERT_TRUE((bool) xss::mapped_pss_tree(file));
+  ASSERT_FALSE((bool) xss::mapped_pss_tree(file, true));
+
+  // a support that is cut short is rebuilt from the BPS
+  std::vector<uint8_t> serialized(support.serialized_bytes());
+  support.serialize(serialized.data());
+  const xss::pss_tree_support rebuilt(bps.data(), bps.size(),
+                                      serialized.data(), 128);
+  for (uint64_t i = 0; i < n; i += 7)
+    ASSERT_EQ(support.pss(i), rebuilt.pss(i)) << i;
+  std::remove(file.c_str());
+}
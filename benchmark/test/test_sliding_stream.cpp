@@ -0,0 +1,80 @@
+//  Copyright (c) 2019 Jonas Ellert
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+
+
+#include <cstdio>
+#include <gtest/gtest.h>
+#include <xss.hpp>
+
+#include "strings/test_lookahead.hpp"
+#include "strings/test_manual.hpp"
+#include "strings/test_runs.hpp"
+
+static void check_sliding(const std::vector<vec_type>& instances) {
+  for (const auto& t : instances) {
+    const uint64_t n = t.size();
+    const uint64_t words = ((n << 1) + 2 + 63) >> 6;
+    std::vector<uint64_t> expected(words + 1);
+    xss::pss_tree(t.data(), expected.data(), n);
+    expected.resize(words);
+
+    // the smallest window cannot serve long copies and lookaheads
+    for (uint64_t window_bytes : {0UL, 4096UL, 1UL << 20}) {
+      std::vector<uint64_t> result;
+      xss::pss_tree_to_sink(
+          t.data(), n,
+          [&](const uint64_t* w, const uint64_t count) {
+            result.insert(result.end(), w, w + count);
+          },
+          window_bytes);
+      ASSERT_EQ(expected, result) << "n=" << n << " window=" << window_bytes;
+    }
+  }
+}
+
+TEST(sliding_stream, manual) {
+  check_sliding(get_instances_for_manual_test());
+}
+
+TEST(sliding_stream, lookahead) {
+  check_sliding(get_instances_for_lookahead_test(64));
+}
+
+TEST(sliding_stream, runs) {
+  check_sliding(get_instances_for_run_of_runs_test(100000));
+}
+
+TEST(sliding_stream, file) {
+  const auto t = generate_test_run_of_runs(100000, 16);
+  const uint64_t n = t.size();
+  std::vector<uint64_t> expected(((n << 1) + 2 + 63) / 64 + 1);
+  xss::pss_tree(t.data(), expected.data(), n);
+  expected.pop_back();
+
+  FILE* file = tmpfile();
+  ASSERT_TRUE(xss::pss_tree_to_file(t.data(), n, fileno(file), 4096));
+  std::vector<uint64_t> result(expected.size());
+  rewind(file);
+  ASSERT_EQ(result.size(),
+            fread(result.data(), sizeof(uint64_t), result.size(), file));
+  ASSERT_EQ(EOF, fgetc(file));
+  fclose(file);
+  ASSERT_EQ(expected, result);
+}
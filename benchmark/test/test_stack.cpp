@@ -56,6 +56,29 @@ TEST(stack, buffered_random) {
   test_random(stack);
 }
 
+TEST(stack, contiguous_random) {
+  // grows geometrically
+  contiguous_telescope_stack growing;
+  test_random(growing);
+
+  // sized up front
+  const uint64_t max_value = 256 * number_of_elements;
+  contiguous_telescope_stack sized(max_value);
+  test_random(sized);
+
+  // caller-supplied words
+  const uint64_t words =
+      contiguous_telescope_stack_words::required_words(max_value);
+  std::vector<uint64_t> buffer(words);
+  contiguous_telescope_stack supplied(
+      contiguous_telescope_stack_words(buffer.data(), words));
+  test_random(supplied);
+
+  buffered_stack<contiguous_telescope_stack, uint64_t> buffered(
+      number_of_elements, contiguous_telescope_stack());
+  test_random(buffered);
+}
+
 TEST(dummy, dummy) {
   telescope_stack stack;
   stack.push(15);
@@ -0,0 +1,148 @@
+//  Copyright (c) 2019 Jonas Ellert
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+
+
+#define XSS_STATISTICS
+
+#include <gtest/gtest.h>
+#include <xss.hpp>
+
+#include "util/random.hpp"
+
+// every position is either processed by the main loop, or skipped by a run
+// extension or lookahead
+static void check_statistics(const uint64_t positions) {
+  const auto stats = xss::get_statistics();
+  ASSERT_EQ(positions, stats.fast_path + stats.slow_path +
+                       stats.run_extension_entries + stats.lookahead_entries);
+  ASSERT_EQ(stats.slow_path, stats.find_pss_calls);
+  ASSERT_LE(stats.run_extensions + stats.lookaheads, stats.slow_path);
+  ASSERT_GE(stats.lce_characters, stats.lce_calls);
+}
+
+TEST(statistics, counters) {
+  auto rng = random_number_generator<uint64_t>();
+  for (uint64_t period : {1, 5, 1000}) {
+    const uint64_t n = 100000;
+    std::vector<uint8_t> text(n);
+    for (uint64_t i = 1; i < n - 1; ++i)
+      text[i] = (i % period == 0) ? 2 : ((rng() % 2) + 1);
+    text[0] = text[n - 1] = 0;
+
+    std::vector<uint32_t> array(n);
+    xss::reset_statistics();
+    xss::nss_array(text.data(), array.data(), n);
+    check_statistics(n - 3); // the array scans start at index 2
+
+    std::vector<uint64_t> bps((2 * n + 2 + 63) / 64 + 1);
+    xss::reset_statistics();
+    xss::pss_tree(text.data(), bps.data(), n);
+    check_statistics(n - 2);
+  }
+}
+
+TEST(statistics, reset) {
+  xss::reset_statistics();
+  const auto stats = xss::get_statistics();
+  ASSERT_EQ(0ULL, stats.fast_path + stats.slow_path + stats.lce_calls);
+}
+
+// texts of the form $(period)^k...$, on which the LCE of two positions
+// typically extends to the end of the text
+static std::vector<uint8_t> periodic_text(const std::string& period,
+                                          const uint64_t n) {
+  std::vector<uint8_t> text(n);
+  for (uint64_t i = 1; i < n - 1; ++i)
+    text[i] = period[i % period.size()];
+  text[0] = text[n - 1] = 0;
+  return text;
+}
+
+template <typename function_type>
+static uint64_t lce_characters(function_type&& function) {
+  xss::reset_statistics();
+  function();
+  return xss::get_statistics().lce_characters;
+}
+
+// the parallel algorithms must not compare (much) more characters than the
+// sequential ones, even if every chunk or block is periodic
+TEST(statistics, parallel_periodic) {
+  const uint64_t n = 1ULL << 20;
+  const uint64_t threads = 4;
+  const uint64_t chunk_size = 1ULL << 14;
+  for (const std::string period : {"a", "ab", "ba", "bbbbbbba"}) {
+    const auto text = periodic_text(period, n);
+    std::vector<uint32_t> expected(n), result(n);
+
+    const uint64_t nss_sequential =
+        lce_characters([&] { xss::nss_array(text.data(), expected.data(), n); });
+    const uint64_t nss_factors = lce_characters([&] {
+      xss::internal::factor_parallel_array<false>(
+          text.data(), result.data(), n, chunk_size, threads,
+          xss::internal::DEFAULT_THRESHOLD);
+    });
+    ASSERT_EQ(expected, result);
+    ASSERT_LE(nss_factors, 2 * nss_sequential + n) << period;
+
+    const uint64_t lyndon_sequential = lce_characters(
+        [&] { xss::lyndon_array(text.data(), expected.data(), n); });
+    const uint64_t lyndon_factors = lce_characters([&] {
+      xss::internal::factor_parallel_array<true>(
+          text.data(), result.data(), n, chunk_size, threads,
+          xss::internal::DEFAULT_THRESHOLD);
+    });
+    ASSERT_EQ(expected, result);
+    ASSERT_LE(lyndon_factors, 2 * lyndon_sequential + n) << period;
+
+    const uint64_t blocks = 16;
+    const uint64_t nss_blocks = lce_characters([&] {
+      xss::internal::parallel_array<true, false>(
+          text.data(), result.data(), n, blocks, threads,
+          xss::internal::DEFAULT_THRESHOLD);
+    });
+    xss::nss_array(text.data(), expected.data(), n);
+    ASSERT_EQ(expected, result);
+    ASSERT_LE(nss_blocks, 2 * nss_sequential + 2 * n) << period;
+
+    const uint64_t pss_sequential =
+        lce_characters([&] { xss::pss_array(text.data(), expected.data(), n); });
+    const uint64_t pss_blocks = lce_characters([&] {
+      xss::internal::parallel_array<false, false>(
+          text.data(), result.data(), n, blocks, threads,
+          xss::internal::DEFAULT_THRESHOLD);
+    });
+    ASSERT_EQ(expected, result);
+    ASSERT_LE(pss_blocks, 2 * pss_sequential + 2 * n) << period;
+
+    const uint64_t words = ((n << 1) + 2 + 63) >> 6;
+    std::vector<uint64_t> expected_tree(words + 1), result_tree(words + 1);
+    const uint64_t tree_sequential = lce_characters(
+        [&] { xss::pss_tree(text.data(), expected_tree.data(), n); });
+    const uint64_t tree_blocks = lce_characters([&] {
+      xss::internal::parallel_pss_tree<uint32_t>(
+          text.data(), result_tree.data(), n, blocks, threads,
+          xss::internal::DEFAULT_THRESHOLD);
+    });
+    expected_tree[words] = result_tree[words] = 0;
+    ASSERT_EQ(expected_tree, result_tree);
+    ASSERT_LE(tree_blocks, 2 * tree_sequential + 2 * n) << period;
+  }
+}
@@ -0,0 +1,193 @@
+//  Copyright (c) 2019 Jonas Ellert
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+
+
+#include <gtest/gtest.h>
+#include <xss.hpp>
+
+#include "util/random.hpp"
+
+// random BPS, where push_permille controls the depth of the tree
+static std::vector<uint64_t> random_bps(const uint64_t nodes,
+                                        const uint64_t push_permille,
+                                        uint64_t& bits) {
+  auto rng = random_number_generator<uint64_t>(0, 999);
+  std::vector<uint64_t> result(((nodes << 1) >> 6) + 2);
+  uint64_t open = 0, remaining = nodes;
+  bits = 0;
+  result[0] |= 1ULL;
+  ++bits;
+  while (remaining > 0 || open > 0) {
+    if (remaining > 0 && (open == 0 || rng() < push_permille)) {
+      result[bits >> 6] |= 1ULL << (bits & 63);
+      ++open;
+      --remaining;
+    } else {
+      --open;
+    }
+    ++bits;
+  }
+  ++bits;
+  return result;
+}
+
+TEST(tree_support, matches_naive) {
+  for (uint64_t push_permille : {10, 500, 600, 900, 990}) {
+    for (uint64_t nodes : {1, 100, 5000, 40000}) {
+      uint64_t bits;
+      const auto bps = random_bps(nodes, push_permille, bits);
+      xss::pss_tree_support_naive naive(bps.data(), bits);
+      xss::pss_tree_support support(bps.data(), bits);
+
+      const uint64_t step = (nodes > 5000) ? 97 : 1;
+      uint64_t ones = 0;
+      for (uint64_t i = 0; i < bits; ++i) {
+        ASSERT_EQ(ones, support.rank(i));
+        if (bps[i >> 6] & (1ULL << (i & 63))) {
+          ASSERT_EQ(i, support.select(++ones));
+        }
+        if (i % step != 0)
+          continue;
+        ASSERT_EQ(naive.find_close(i), support.find_close(i)) << i;
+        if (i > 0 && i < bits - 1) {
+          ASSERT_EQ(naive.enclose(i), support.enclose(i)) << i;
+        }
+      }
+    }
+  }
+}
+
+TEST(tree_support, large_blocks) {
+  // the blocks grow to 1024 bits for BPS of at least 2^22 bits
+  for (uint64_t push_permille : {500, 600}) {
+    uint64_t bits;
+    const auto bps = random_bps(1ULL << 22, push_permille, bits);
+    xss::pss_tree_support_naive naive(bps.data(), bits);
+    xss::pss_tree_support support(bps.data(), bits);
+
+    uint64_t ones = 0;
+    for (uint64_t i = 0; i < bits; ++i) {
+      if (i % 61 == 0) {
+        ASSERT_EQ(ones, support.rank(i));
+      }
+      if (bps[i >> 6] & (1ULL << (i & 63))) {
+        ASSERT_EQ(i, support.select(++ones));
+      }
+      if (i % 4099 != 0)
+        continue;
+      ASSERT_EQ(naive.find_close(i), support.find_close(i)) << i;
+      if (i > 0 && i < bits - 1) {
+        ASSERT_EQ(naive.enclose(i), support.enclose(i)) << i;
+      }
+    }
+  }
+}
+
+TEST(tree_support, distant_select_samples) {
+  // the offsets of the samples after the first long run of closing
+  // parentheses do not fit into 16 bits, and neither does the offset of the
+  // last sample (which lies at the end of the second run)
+  const uint64_t first = 5000, run = 1ULL << 26, second = 70000;
+  const uint64_t bits = first + run + second + run;
+  std::vector<uint64_t> bps((bits >> 6) + 2);
+  const auto set_ones = [&](const uint64_t begin, const uint64_t count) {
+    for (uint64_t i = begin; i < begin + count; ++i)
+      bps[i >> 6] |= 1ULL << (i & 63);
+  };
+  set_ones(0, first);
+  set_ones(first + run, second);
+  xss::pss_tree_support support(bps.data(), bits);
+
+  for (uint64_t k = 1; k <= first; ++k)
+    ASSERT_EQ(k - 1, support.select(k)) << k;
+  for (uint64_t k = 1; k <= second; ++k)
+    ASSERT_EQ(first + run + k - 1, support.select(first + k)) << k;
+  for (uint64_t i = 0; i < bits; i += 4097) {
+    const uint64_t expected =
+        std::min(i, first) + std::min(i - std::min(i, first + run), second);
+    ASSERT_EQ(expected, support.rank(i)) << i;
+  }
+  ASSERT_EQ(first + run + second + second - 1,
+            support.find_close(first + run));
+}
+
+TEST(tree_support, batch_queries) {
+  auto rng = random_number_generator<uint64_t>();
+  for (uint64_t n : {3, 100, 100000}) {
+    std::vector<uint8_t> text(n);
+    for (uint64_t i = 1; i < n - 1; ++i)
+      text[i] = (rng() % 4) + 1;
+    text[0] = text[n - 1] = 0;
+    std::vector<uint64_t> bps(((2 * n + 2) >> 6) + 2);
+    xss::pss_tree(text.data(), bps.data(), n);
+    xss::pss_tree_support support(bps.data(), 2 * n + 2);
+
+    for (bool sorted : {false, true}) {
+      std::vector<uint64_t> queries(1000);
+      for (auto& q : queries)
+        q = 1 + rng() % (n - 2);
+      if (sorted)
+        std::sort(queries.begin(), queries.end());
+
+      std::vector<uint64_t> pss(queries.size()), nss(queries.size()),
+          lyndon(queries.size());
+      support.pss_batch(queries.data(), pss.data(), queries.size());
+      support.nss_batch(queries.data(), nss.data(), queries.size());
+      support.lyndon_batch(queries.data(), lyndon.data(), queries.size());
+      for (uint64_t q = 0; q < queries.size(); ++q) {
+        ASSERT_EQ(support.pss(queries[q]), pss[q]);
+        ASSERT_EQ(support.nss(queries[q]), nss[q]);
+        ASSERT_EQ(support.lyndon(queries[q]), lyndon[q]);
+      }
+    }
+  }
+}
+
+TEST(tree_support, fused) {
+  auto rng = random_number_generator<uint64_t>();
+  for (uint64_t n : {3, 100, 5000, 300000}) {
+    for (uint64_t sigma : {2, 4}) {
+      std::vector<uint8_t> text(n);
+      for (uint64_t i = 1; i < n - 1; ++i)
+        text[i] = (rng() % sigma) + 1;
+      // long runs are written with append_copy
+      for (uint64_t i = n / 3; i < n / 2; ++i)
+        text[i] = text[i - 7];
+      text[0] = text[n - 1] = 0;
+
+      std::vector<uint64_t> bps(((2 * n + 2) >> 6) + 2);
+      xss::pss_tree(text.data(), bps.data(), n);
+      xss::pss_tree_support support(bps.data(), 2 * n + 2);
+
+      std::vector<uint64_t> fused_bps(bps.size());
+      const auto fused =
+          xss::pss_tree_with_support(text.data(), fused_bps.data(), n);
+      ASSERT_EQ(bps, fused_bps);
+
+      for (uint64_t i = 0; i < 2 * n + 2; ++i)
+        ASSERT_EQ(support.rank(i), fused.rank(i));
+      const uint64_t step = (n > 5000) ? 97 : 1;
+      for (uint64_t i = 1; i < n - 1; i += step) {
+        ASSERT_EQ(support.pss(i), fused.pss(i));
+        ASSERT_EQ(support.nss(i), fused.nss(i));
+      }
+    }
+  }
+}
@@ -0,0 +1,82 @@
+//  Copyright (c) 2019 Jonas Ellert
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+
+
+#include <gtest/gtest.h>
+#include <xss.hpp>
+
+#include "util/random.hpp"
+
+// compares the sentinel-free overloads with the text $text$, where the
+// characters are widened so that $ can be added explicitly
+static void check_without_sentinels(const std::vector<uint8_t>& text) {
+  const uint64_t n = text.size();
+  std::vector<uint16_t> widened(n + 2, 0);
+  for (uint64_t i = 0; i < n; ++i)
+    widened[i + 1] = text[i] + 1;
+
+  std::vector<uint32_t> expected(n + 2), actual(n + 2);
+  xss::pss_array(widened.data(), expected.data(), n + 2);
+  xss::pss_array(xss::without_sentinels, text.data(), actual.data(), n);
+  ASSERT_EQ(expected, actual);
+
+  xss::nss_array(widened.data(), expected.data(), n + 2);
+  xss::nss_array(xss::without_sentinels, text.data(), actual.data(), n);
+  ASSERT_EQ(expected, actual);
+
+  xss::lyndon_array(widened.data(), expected.data(), n + 2);
+  xss::lyndon_array(xss::without_sentinels, text.data(), actual.data(), n);
+  ASSERT_EQ(expected, actual);
+
+  // one extra word, since the tree may flush one word too many
+  const uint64_t words = (2 * (n + 2) + 2 + 63) / 64 + 1;
+  std::vector<uint64_t> expected_bps(words, 0), actual_bps(words, 0);
+  xss::pss_tree(widened.data(), expected_bps.data(), n + 2);
+  xss::pss_tree(xss::without_sentinels, text.data(), actual_bps.data(), n);
+  ASSERT_EQ(expected_bps, actual_bps);
+}
+
+TEST(virtual_sentinels, random) {
+  auto rng = random_number_generator<uint64_t>();
+  for (uint64_t sigma : {1, 2, 4, 256}) {
+    for (uint64_t n : {1, 2, 10, 100, 1000, 100000}) {
+      std::vector<uint8_t> text(n);
+      for (auto& c : text)
+        c = (sigma == 256) ? rng() : (rng() % sigma);
+      check_without_sentinels(text);
+    }
+  }
+}
+
+TEST(virtual_sentinels, runs) {
+  auto rng = random_number_generator<uint64_t>();
+  for (uint64_t period : {1, 3, 17, 200}) {
+    std::vector<uint8_t> text;
+    std::vector<uint8_t> word(period);
+    for (auto& c : word)
+      c = rng() % 3;
+    for (uint64_t rep = 0; rep < 100000 / period; ++rep)
+      text.insert(text.end(), word.begin(), word.end());
+    text.push_back(rng() % 3);
+    check_without_sentinels(text);
+    text.insert(text.begin(), 0);
+    check_without_sentinels(text);
+  }
+}
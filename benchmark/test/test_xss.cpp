@@ -98,6 +98,10 @@ static void instance_tests(instance_collection&& instances) {
       std::reverse(t.begin(), t.end());
       xss::pss_tree(t.data(), bv.data(), t.size());
       check_type::check_bps(t, bv);
+      bv = sdsl::bit_vector(2 * t.size() + 2);
+      xss::pss_tree<uint64_t, contiguous_telescope_stack>(t.data(), bv.data(),
+                                                          t.size());
+      check_type::check_bps(t, bv);
     }
   };
 
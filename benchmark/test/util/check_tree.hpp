@@ -23,6 +23,7 @@
 #include "check_array.hpp"
 #include <gtest/gtest.h>
 
+#include <xss/tree/support/pss_tree_support.hpp>
 #include <xss/tree/support/pss_tree_support_naive.hpp>
 #include <xss/tree/support/pss_tree_support_sdsl.hpp>
 
@@ -65,5 +66,11 @@ struct check_tree {
       EXPECT_EQ(pss[i], support2.pss(i));
       EXPECT_EQ(nss[i], support2.nss(i));
     }
+
+    xss::pss_tree_support support3(bps);
+    for (uint64_t i = 1; i < text.size() - 1; ++i) {
+      EXPECT_EQ(pss[i], support3.pss(i));
+      EXPECT_EQ(nss[i], support3.nss(i));
+    }
   }
 };
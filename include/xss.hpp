@@ -21,5 +21,17 @@
 #pragma once
 
 #include "xss/array/algorithm.hpp"
+#include "xss/array/auto_threshold.hpp"
+#include "xss/array/external.hpp"
+#include "xss/array/packed.hpp"
+#include "xss/array/parallel.hpp"
+#include "xss/common/arena.hpp"
+#include "xss/common/large_buffer.hpp"
+#include "xss/common/mapped_text.hpp"
 #include "xss/tree/algorithm.hpp"
+#include "xss/tree/parallel.hpp"
+#include "xss/tree/serialization.hpp"
+#include "xss/tree/sliding_stream.hpp"
+#include "xss/tree/support/pss_tree_fused.hpp"
+#include "xss/tree/support/pss_tree_support.hpp"
 #include "xss/tree/support/pss_tree_support_naive.hpp"
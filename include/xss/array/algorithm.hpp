@@ -24,49 +24,33 @@
 #include "find_pss.hpp"
 #include "run_extension.hpp"
 #include "xss/common/context.hpp"
+#include "xss/common/packed_dna.hpp"
 #include "xss/common/util.hpp"
 
 namespace xss {
 
 namespace internal {
+
+  // The scans process the positions in [begin, end), where the PSS chain of
+  // begin - 1 is already in place. For the blocks of the parallel algorithms,
+  // all positions preceding the block are hidden behind the sentinel at index
+  // 0, i.e. the block starts with array[begin - 1] = 0.
   template <bool build_nss,
             bool build_lyndon,
-            typename index_type,
-            typename value_type>
-  static auto
-  pss_and_x_array(value_type const* const text,
-                  index_type* const array,
-                  index_type* const aux,
-                  uint64_t const n,
-                  uint64_t threshold = internal::DEFAULT_THRESHOLD) {
-    using namespace internal;
-
-    static_assert(!(build_nss && build_lyndon));
-
-    if constexpr (build_nss)
-      warn_type_width<index_type>(n, "xss::pss_and_nss_array");
-    else if constexpr (build_lyndon)
-      warn_type_width<index_type>(n, "xss::pss_and_lyndon_array");
-    else
-      warn_type_width<index_type>(n, "xss::pss_array");
-
-    fix_threshold(threshold);
-
-    static_assert(std::is_unsigned<index_type>::value);
-    memset(array, 0, n * sizeof(index_type));
-    if constexpr (build_nss || build_lyndon) {
-      memset(array, 0, n * sizeof(index_type));
-    }
-
-    array_context_type<index_type, value_type> ctx{text, array, (index_type) n, aux};
-
-    array[0] = 0; // will be overwritten with n later
-    if constexpr (build_nss || build_lyndon) {
-      aux[0] = n - 1;
-    }
+            typename ctx_type,
+            typename index_type>
+  static void pss_and_x_array_scan(ctx_type& ctx,
+                                   index_type const begin,
+                                   index_type const end,
+                                   uint64_t const threshold) {
+    const auto text = ctx.text;
+    const auto array = ctx.array;
+    const auto aux = ctx.aux;
 
     index_type j, lce;
-    for (index_type i = 1; i < n - 1; ++i) {
+    for (index_type i = begin; i < end; ++i) {
+      if (lce_truncated(ctx))
+        return;
       j = i - 1;
       lce = ctx.get_lce.without_bounds(j, i);
 
@@ -84,12 +68,18 @@ namespace internal {
 
         if (xss_likely(lce <= threshold)) {
           array[i] = j;
+          xss_statistics_add(fast_path, 1);
           continue;
         }
       }
 
+      if (lce_truncated(ctx))
+        return;
+      xss_statistics_add(slow_path, 1);
       index_type max_lce, max_lce_j, pss_of_i;
       xss_array_find_pss(ctx, j, i, lce, max_lce_j, max_lce, pss_of_i);
+      if (lce_truncated(ctx))
+        return;
 
       if constexpr (build_nss || build_lyndon) {
         while (j > pss_of_i) {
@@ -111,12 +101,142 @@ namespace internal {
         pss_array_amortized_lookahead<build_nss, build_lyndon>(
             ctx, max_lce_j, i, max_lce, distance);
     }
+  }
+
+  template <typename ctx_type, typename index_type>
+  static void nss_array_scan(ctx_type& ctx,
+                             index_type const begin,
+                             index_type const end,
+                             uint64_t const threshold) {
+    const auto text = ctx.text;
+    const auto array = ctx.array;
+
+    index_type j, lce;
+    for (index_type i = begin; i < end; ++i) {
+      if (lce_truncated(ctx))
+        return;
+      j = i - 1;
+      lce = ctx.get_lce.without_bounds(j, i);
+
+      if (xss_likely(lce < threshold)) {
+        while (text[j + lce] > text[i + lce]) {
+          index_type next_j = array[j];
+          array[j] = i;
+          j = next_j;
+          lce = ctx.get_lce.without_bounds(j, i);
+          if (xss_unlikely(lce > threshold))
+            break;
+        }
+
+        if (xss_likely(lce <= threshold)) {
+          array[i] = j;
+          xss_statistics_add(fast_path, 1);
+          continue;
+        }
+      }
+
+      if (lce_truncated(ctx))
+        return;
+      xss_statistics_add(slow_path, 1);
+      index_type max_lce, max_lce_j, pss_of_i;
+      xss_array_find_pss(ctx, j, i, lce, max_lce_j, max_lce, pss_of_i);
+      if (lce_truncated(ctx))
+        return;
+
+      while (j > pss_of_i) {
+        index_type next_j = array[j];
+        array[j] = i;
+        j = next_j;
+      }
+      array[i] = pss_of_i;
+
+      const index_type distance = i - max_lce_j;
+      if (xss_unlikely(max_lce >= 2 * distance))
+        nss_array_run_extension(ctx, max_lce_j, i, max_lce, distance);
+      else
+        nss_array_amortized_lookahead(ctx, max_lce_j, i, max_lce, distance);
+    }
+  }
+
+  template <typename ctx_type, typename index_type>
+  static void lyndon_array_scan(ctx_type& ctx,
+                                index_type const begin,
+                                index_type const end,
+                                uint64_t const threshold) {
+    const auto text = ctx.text;
+    const auto array = ctx.array;
+
+    index_type j, lce;
+    for (index_type i = begin; i < end; ++i) {
+      if (lce_truncated(ctx))
+        return;
+      j = i - 1;
+      lce = ctx.get_lce.without_bounds(j, i);
+
+      if (xss_likely(lce < threshold)) {
+        while (text[j + lce] > text[i + lce]) {
+          index_type next_j = array[j];
+          array[j] = i - j;
+          j = next_j;
+          lce = ctx.get_lce.without_bounds(j, i);
+          if (xss_unlikely(lce > threshold))
+            break;
+        }
+
+        if (xss_likely(lce <= threshold)) {
+          array[i] = j;
+          xss_statistics_add(fast_path, 1);
+          continue;
+        }
+      }
+
+      if (lce_truncated(ctx))
+        return;
+      xss_statistics_add(slow_path, 1);
+      index_type max_lce, max_lce_j, pss_of_i;
+      xss_array_find_pss(ctx, j, i, lce, max_lce_j, max_lce, pss_of_i);
+      if (lce_truncated(ctx))
+        return;
+
+      while (j > pss_of_i) {
+        index_type next_j = array[j];
+        array[j] = i - j;
+        j = next_j;
+      }
+      array[i] = pss_of_i;
+
+      const index_type distance = i - max_lce_j;
+      if (xss_unlikely(max_lce >= 2 * distance))
+        lyndon_array_run_extension(ctx, max_lce_j, i, max_lce, distance);
+      else
+        lyndon_array_amortized_lookahead(ctx, max_lce_j, i, max_lce);
+    }
+  }
+
+  // The following functions compute the arrays for a given context, whose
+  // arrays are zero-initialized.
+  template <bool build_nss, bool build_lyndon, typename ctx_type>
+  static void run_pss_and_x_array(ctx_type& ctx, uint64_t const threshold) {
+    using index_type = std::remove_const_t<decltype(ctx.n)>;
+    const auto array = ctx.array;
+    const auto aux = ctx.aux;
+    const index_type n = ctx.n;
+
+    array[0] = 0; // will be overwritten with n later
+    if constexpr (build_nss || build_lyndon) {
+      aux[0] = n - 1;
+    }
+
+    array[1] = 0;
+    pss_and_x_array_scan<build_nss, build_lyndon>(ctx, (index_type) 2,
+                                                  (index_type)(n - 1),
+                                                  threshold);
 
     // PSS does not exist <=> pss[i] = n
     array[0] = array[n - 1] = n;
 
     if constexpr (build_nss || build_lyndon) {
-      j = n - 2;
+      index_type j = n - 2;
       while (j > 0) {
         if constexpr (build_nss)
           aux[j] = n - 1;
@@ -127,6 +247,121 @@ namespace internal {
     }
   }
 
+  template <typename ctx_type>
+  static void run_nss_array(ctx_type& ctx, uint64_t const threshold) {
+    using index_type = std::remove_const_t<decltype(ctx.n)>;
+    const auto array = ctx.array;
+    const index_type n = ctx.n;
+
+    array[0] = 0; // will be overwritten with n - 1 later
+
+    array[1] = 0;
+    nss_array_scan(ctx, (index_type) 2, (index_type)(n - 1), threshold);
+
+    // PROCESS ELEMENTS WITHOUT NSS
+    index_type j = n - 2;
+    while (j > 0) {
+      index_type next_j = array[j];
+      array[j] = n - 1;
+      j = next_j;
+    }
+
+    array[0] = n - 1;
+    array[n - 1] = n;
+  }
+
+  template <typename ctx_type>
+  static void run_lyndon_array(ctx_type& ctx, uint64_t const threshold) {
+    using index_type = std::remove_const_t<decltype(ctx.n)>;
+    const auto array = ctx.array;
+    const index_type n = ctx.n;
+
+    array[0] = 0; // will be overwritten with n - 1 later
+
+    array[1] = 0;
+    lyndon_array_scan(ctx, (index_type) 2, (index_type)(n - 1), threshold);
+
+    // PROCESS ELEMENTS WITHOUT NSS
+    index_type j = n - 2;
+    while (j > 0) {
+      index_type next_j = array[j];
+      array[j] = n - j - 1;
+      j = next_j;
+    }
+
+    array[0] = n - 1;
+    array[n - 1] = 1;
+  }
+
+  template <bool build_nss,
+            bool build_lyndon,
+            typename index_type,
+            typename text_type>
+  static auto
+  pss_and_x_array(text_type const text,
+                  index_type* const array,
+                  index_type* const aux,
+                  uint64_t const n,
+                  uint64_t threshold = internal::DEFAULT_THRESHOLD) {
+    using namespace internal;
+
+    static_assert(!(build_nss && build_lyndon));
+
+    if constexpr (build_nss)
+      warn_type_width<index_type>(n, "xss::pss_and_nss_array");
+    else if constexpr (build_lyndon)
+      warn_type_width<index_type>(n, "xss::pss_and_lyndon_array");
+    else
+      warn_type_width<index_type>(n, "xss::pss_array");
+
+    fix_threshold(threshold);
+
+    static_assert(std::is_unsigned<index_type>::value);
+    memset(array, 0, n * sizeof(index_type));
+    if constexpr (build_nss || build_lyndon) {
+      memset(array, 0, n * sizeof(index_type));
+    }
+
+    using value_type = typename text_traits<text_type>::value_type;
+    array_context_type<index_type, value_type, text_type> ctx{
+        text, array, (index_type) n, aux};
+    run_pss_and_x_array<build_nss, build_lyndon>(ctx, threshold);
+  }
+
+  template <typename index_type, typename text_type>
+  static void build_nss_array(text_type const text,
+                              index_type* const array,
+                              uint64_t const n,
+                              uint64_t threshold) {
+    warn_type_width<index_type>(n, "xss::nss_array");
+    fix_threshold(threshold);
+
+    static_assert(std::is_unsigned<index_type>::value);
+    memset(array, 0, n * sizeof(index_type));
+
+    using value_type = typename text_traits<text_type>::value_type;
+    array_context_type<index_type, value_type, text_type> ctx{text, array,
+                                                             (index_type) n};
+    run_nss_array(ctx, threshold);
+  }
+
+  template <typename index_type, typename text_type>
+  static void build_lyndon_array(text_type const text,
+                                 index_type* const array,
+                                 uint64_t const n,
+                                 uint64_t threshold) {
+    warn_type_width<index_type>(n, "xss::lyndon_array");
+    fix_threshold(threshold);
+
+    static_assert(std::is_unsigned<index_type>::value);
+    memset(array, 0, n * sizeof(index_type));
+
+    using value_type = typename text_traits<text_type>::value_type;
+    array_context_type<index_type, value_type, text_type> ctx{text, array,
+                                                             (index_type) n};
+    run_lyndon_array(ctx, threshold);
+  }
+
 } // namespace internal
 
 template <typename index_type, typename value_type>
@@ -165,65 +400,7 @@ static void nss_array(value_type const* const text,
                       index_type* const array,
                       uint64_t const n,
                       uint64_t threshold = internal::DEFAULT_THRESHOLD) {
-  using namespace internal;
-  warn_type_width<index_type>(n, "xss::nss_array");
-  fix_threshold(threshold);
-
-  static_assert(std::is_unsigned<index_type>::value);
-  memset(array, 0, n * sizeof(index_type));
-
-  array_context_type<index_type, value_type> ctx{text, array, (index_type) n};
-
-  array[0] = 0; // will be overwritten with n - 1 later
-
-  index_type j, lce;
-  for (index_type i = 1; i < n - 1; ++i) {
-    j = i - 1;
-    lce = ctx.get_lce.without_bounds(j, i);
-
-    if (xss_likely(lce < threshold)) {
-      while (text[j + lce] > text[i + lce]) {
-        index_type next_j = array[j];
-        array[j] = i;
-        j = next_j;
-        lce = ctx.get_lce.without_bounds(j, i);
-        if (xss_unlikely(lce > threshold))
-          break;
-      }
-
-      if (xss_likely(lce <= threshold)) {
-        array[i] = j;
-        continue;
-      }
-    }
-
-    index_type max_lce, max_lce_j, pss_of_i;
-    xss_array_find_pss(ctx, j, i, lce, max_lce_j, max_lce, pss_of_i);
-
-    while (j > pss_of_i) {
-      index_type next_j = array[j];
-      array[j] = i;
-      j = next_j;
-    }
-    array[i] = pss_of_i;
-
-    const index_type distance = i - max_lce_j;
-    if (xss_unlikely(max_lce >= 2 * distance))
-      nss_array_run_extension(ctx, max_lce_j, i, max_lce, distance);
-    else
-      nss_array_amortized_lookahead(ctx, max_lce_j, i, max_lce, distance);
-  }
-
-  // PROCESS ELEMENTS WITHOUT NSS
-  j = n - 2;
-  while (j > 0) {
-    index_type next_j = array[j];
-    array[j] = n - 1;
-    j = next_j;
-  }
-
-  array[0] = n - 1;
-  array[n - 1] = n;
+  internal::build_nss_array(text, array, n, threshold);
 }
 
 template <typename index_type, typename value_type>
@@ -231,65 +408,79 @@ static void lyndon_array(value_type const* const text,
                          index_type* const array,
                          uint64_t const n,
                          uint64_t threshold = internal::DEFAULT_THRESHOLD) {
-  using namespace internal;
-  warn_type_width<index_type>(n, "xss::lyndon_array");
-  fix_threshold(threshold);
-
-  static_assert(std::is_unsigned<index_type>::value);
-  memset(array, 0, n * sizeof(index_type));
-
-  array_context_type<index_type, value_type> ctx{text, array, (index_type) n};
-
-  array[0] = 0; // will be overwritten with n - 1 later
+  internal::build_lyndon_array(text, array, n, threshold);
+}
 
-  index_type j, lce;
-  for (index_type i = 1; i < n - 1; ++i) {
-    j = i - 1;
-    lce = ctx.get_lce.without_bounds(j, i);
+// The following overloads take a text of length n without sentinels, i.e.
+// text[0] and text[n - 1] may be arbitrary characters. The result is the same
+// as for the text $text$ of length n + 2, where $ is smaller than all other
+// characters (the arrays must provide space for n + 2 entries).
 
-    if (xss_likely(lce < threshold)) {
-      while (text[j + lce] > text[i + lce]) {
-        index_type next_j = array[j];
-        array[j] = i - j;
-        j = next_j;
-        lce = ctx.get_lce.without_bounds(j, i);
-        if (xss_unlikely(lce > threshold))
-          break;
-      }
+template <typename index_type, typename value_type>
+static auto pss_array(without_sentinels_type,
+                      value_type const* const text,
+                      index_type* const pss,
+                      uint64_t const n,
+                      uint64_t threshold = internal::DEFAULT_THRESHOLD) {
+  return internal::pss_and_x_array<false, false>(
+      internal::with_virtual_sentinels(text, n), pss, (index_type*) nullptr,
+      n + 2, threshold);
+}
 
-      if (xss_likely(lce <= threshold)) {
-        array[i] = j;
-        continue;
-      }
-    }
+template <typename index_type, typename value_type>
+static void nss_array(without_sentinels_type,
+                      value_type const* const text,
+                      index_type* const array,
+                      uint64_t const n,
+                      uint64_t threshold = internal::DEFAULT_THRESHOLD) {
+  internal::build_nss_array(internal::with_virtual_sentinels(text, n), array,
+                            n + 2, threshold);
+}
 
-    index_type max_lce, max_lce_j, pss_of_i;
-    xss_array_find_pss(ctx, j, i, lce, max_lce_j, max_lce, pss_of_i);
+template <typename index_type, typename value_type>
+static void lyndon_array(without_sentinels_type,
+                         value_type const* const text,
+                         index_type* const array,
+                         uint64_t const n,
+                         uint64_t threshold = internal::DEFAULT_THRESHOLD) {
+  internal::build_lyndon_array(internal::with_virtual_sentinels(text, n),
+                               array, n + 2, threshold);
+}
 
-    while (j > pss_of_i) {
-      index_type next_j = array[j];
-      array[j] = i - j;
-      j = next_j;
-    }
-    array[i] = pss_of_i;
+// The following overloads take a 2-bit packed DNA text of length n (see
+// packed_dna_type), the arrays must provide space for n + 2 entries.
 
-    const index_type distance = i - max_lce_j;
-    if (xss_unlikely(max_lce >= 2 * distance))
-      lyndon_array_run_extension(ctx, max_lce_j, i, max_lce, distance);
-    else
-      lyndon_array_amortized_lookahead(ctx, max_lce_j, i, max_lce);
-  }
+template <typename index_type>
+static auto pss_array(packed_dna_type,
+                      uint64_t const* const text,
+                      index_type* const pss,
+                      uint64_t const n,
+                      uint64_t threshold = internal::DEFAULT_THRESHOLD) {
+  return internal::pss_and_x_array<false, false>(
+      internal::with_virtual_sentinels(packed_dna, text, n), pss,
+      (index_type*) nullptr, n + 2, threshold);
+}
 
-  // PROCESS ELEMENTS WITHOUT NSS
-  j = n - 2;
-  while (j > 0) {
-    index_type next_j = array[j];
-    array[j] = n - j - 1;
-    j = next_j;
-  }
+template <typename index_type>
+static void nss_array(packed_dna_type,
+                      uint64_t const* const text,
+                      index_type* const array,
+                      uint64_t const n,
+                      uint64_t threshold = internal::DEFAULT_THRESHOLD) {
+  internal::build_nss_array(
+      internal::with_virtual_sentinels(packed_dna, text, n), array, n + 2,
+      threshold);
+}
 
-  array[0] = n - 1;
-  array[n - 1] = 1;
+template <typename index_type>
+static void lyndon_array(packed_dna_type,
+                         uint64_t const* const text,
+                         index_type* const array,
+                         uint64_t const n,
+                         uint64_t threshold = internal::DEFAULT_THRESHOLD) {
+  internal::build_lyndon_array(
+      internal::with_virtual_sentinels(packed_dna, text, n), array, n + 2,
+      threshold);
 }
 
 } // namespace xss
@@ -37,7 +37,9 @@ namespace internal {
                                 index_type& i,
                                 index_type max_lce,
                                 const index_type distance) {
-    const index_type anchor = get_anchor(&(ctx.text[i]), max_lce);
+    const index_type anchor =
+        std::min(ctx_type::anchor_type::get(ctx, i, max_lce),
+                 (index_type)(ctx.end - i));
     // copy NSS values up to anchor
     for (index_type k = 1; k < anchor; ++k) {
       ctx.array[i + k] = ctx.array[j + k] + distance;
@@ -47,6 +49,8 @@ namespace internal {
         ctx.aux[i + k] = ctx.aux[j + k];
     }
     i += anchor - 1;
+    xss_statistics_add(lookaheads, 1);
+    xss_statistics_add(lookahead_entries, anchor - 1);
   }
 
   template <typename ctx_type, typename index_type>
@@ -57,7 +61,9 @@ namespace internal {
                                 index_type max_lce,
                                 const index_type distance) {
 
-    const index_type anchor = get_anchor(&(ctx.text[i]), max_lce);
+    const index_type anchor =
+        std::min(ctx_type::anchor_type::get(ctx, i, max_lce),
+                 (index_type)(ctx.end - i));
     index_type next_pss = i;
     // copy NSS values up to anchor
     for (index_type k = 1; k < anchor; ++k) {
@@ -69,13 +75,17 @@ namespace internal {
       }
     }
     i += anchor - 1;
+    xss_statistics_add(lookaheads, 1);
+    xss_statistics_add(lookahead_entries, anchor - 1);
   }
 
   template <typename ctx_type, typename index_type>
   xss_always_inline static void lyndon_array_amortized_lookahead(
       ctx_type& ctx, const index_type j, index_type& i, index_type max_lce) {
 
-    const index_type anchor = get_anchor(&(ctx.text[i]), max_lce);
+    const index_type anchor =
+        std::min(ctx_type::anchor_type::get(ctx, i, max_lce),
+                 (index_type)(ctx.end - i));
     index_type next_pss = i;
     // copy NSS values up to anchor
     for (index_type k = 1; k < anchor; ++k) {
@@ -87,6 +97,8 @@ namespace internal {
       }
     }
     i += anchor - 1;
+    xss_statistics_add(lookaheads, 1);
+    xss_statistics_add(lookahead_entries, anchor - 1);
   }
 
 } // namespace internal
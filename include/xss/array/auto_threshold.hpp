@@ -0,0 +1,179 @@
+//  Copyright (c) 2019 Jonas Ellert
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+#include "parallel.hpp"
+#include "xss/common/util.hpp"
+
+namespace xss {
+
+namespace internal {
+
+  constexpr static uint64_t AUTO_THRESHOLD_WINDOW = 1ULL << 14;
+  constexpr static uint64_t AUTO_THRESHOLD_WINDOWS = 4;
+  constexpr static uint64_t AUTO_THRESHOLD_CANDIDATES[] = {16, DEFAULT_THRESHOLD,
+                                                           1024, 4096};
+  // the calibration scans about 262K positions, i.e. at most 1/64 of the text
+  constexpr static uint64_t AUTO_THRESHOLD_MIN_N = 1ULL << 24;
+
+  // Cost model of the scan (fitted to the NSS construction on the synthetic
+  // texts of the benchmark): an LCE query costs as much as comparing 16
+  // characters, and an LCE that exceeds the threshold leads to the slow path,
+  // which costs about 32 queries.
+  constexpr static uint64_t AUTO_THRESHOLD_CHARACTERS_PER_QUERY = 16;
+  constexpr static uint64_t AUTO_THRESHOLD_QUERIES_PER_SLOW_PATH = 32;
+
+  // Maps the window [shift + 1, shift + size] of an array to data[1, size],
+  // such that a window of the text can be processed with global indices.
+  // The entry of the sentinel (which may be read by the scan) is data[0].
+  template <typename index_type>
+  struct shifted_array {
+    index_type* data = nullptr;
+    uint64_t shift = 0;
+
+    xss_always_inline index_type& operator[](const uint64_t i) const {
+      return data[(i == 0) ? 0 : i - shift];
+    }
+  };
+
+  // Bounded LCE queries that count the queries, the compared characters, and
+  // the results of queries without upper bound (which decide whether the
+  // slow path is taken) that exceed each of the candidate thresholds. This is
+  // independent of XSS_STATISTICS.
+  template <typename index_type, typename value_type>
+  struct counting_lce_type : public bounded_lce_type<index_type, value_type> {
+    using base_type = bounded_lce_type<index_type, value_type>;
+    constexpr static uint64_t candidates = std::size(AUTO_THRESHOLD_CANDIDATES);
+
+    mutable uint64_t queries = 0;
+    mutable uint64_t characters = 0;
+    mutable uint64_t long_lces[candidates] = {};
+
+    xss_always_inline index_type
+    with_both_bounds(const index_type l,
+                     const index_type r,
+                     const index_type lower,
+                     const index_type upper) const {
+      const index_type result =
+          base_type::with_both_bounds(l, r, lower, upper);
+      ++queries;
+      characters += result - lower + ((result < upper) ? 1 : 0);
+      return result;
+    }
+
+    xss_always_inline index_type without_bounds(const index_type l,
+                                                const index_type r,
+                                                const index_type lce = 0) const {
+      const index_type result = base_type::without_bounds(l, r, lce);
+      ++queries;
+      characters += result - lce + 1;
+      for (uint64_t k = 0; k < candidates; ++k)
+        long_lces[k] += (result > AUTO_THRESHOLD_CANDIDATES[k]) ? 1 : 0;
+      return result;
+    }
+
+    xss_always_inline index_type with_upper_bound(
+        const index_type l, const index_type r, const index_type upper) const {
+      return with_both_bounds(l, r, 0, upper);
+    }
+
+    xss_always_inline index_type with_lower_bound(
+        const index_type l, const index_type r, const index_type lower) const {
+      return without_bounds(l, r, lower);
+    }
+  };
+
+  template <typename index_type, typename value_type>
+  struct is_bounded_lce<counting_lce_type<index_type, value_type>>
+      : std::true_type {};
+
+  // Estimated cost of scanning the windows with the k-th candidate, where
+  // each window is processed like a block of the parallel algorithm (i.e. on
+  // the actual text). The estimate only depends on the text.
+  template <typename value_type>
+  static uint64_t window_cost(value_type const* const text,
+                              uint64_t const n,
+                              uint64_t const k,
+                              std::vector<uint64_t>& scratch) {
+    using array_type = shifted_array<uint64_t>;
+    using lce_type = counting_lce_type<uint64_t, value_type>;
+    const uint64_t stride = (n - 2) / AUTO_THRESHOLD_WINDOWS;
+    uint64_t cost = 0;
+    for (uint64_t w = 0; w < AUTO_THRESHOLD_WINDOWS; ++w) {
+      const uint64_t begin = 1 + w * stride;
+      const uint64_t end = begin + AUTO_THRESHOLD_WINDOW;
+      std::fill(scratch.begin(), scratch.end(), 0);
+      array_block_context_type<uint64_t, value_type, array_type, lce_type> ctx(
+          text, array_type{scratch.data(), begin - 1}, n, begin, end);
+      ctx.array[begin] = 0;
+      nss_array_scan(ctx, (uint64_t)(begin + 1), ctx.end,
+                     AUTO_THRESHOLD_CANDIDATES[k]);
+      cost += ctx.get_lce.queries +
+              ctx.get_lce.characters / AUTO_THRESHOLD_CHARACTERS_PER_QUERY +
+              ctx.get_lce.long_lces[k] * AUTO_THRESHOLD_QUERIES_PER_SLOW_PATH;
+    }
+    return cost;
+  }
+
+} // namespace internal
+
+// Picks a threshold for the given text (with sentinels) by estimating the cost
+// of the NSS construction on a few windows of the text from the number of LCE
+// queries, compared characters and slow paths. The result only depends on the
+// text. Most texts are insensitive to the threshold, but texts that consist of
+// short runs prefer small thresholds, and some highly repetitive texts prefer
+// large ones. All candidates are small constants, because the windows do not
+// represent the whole text: with an unbounded threshold, a long run outside of
+// the windows would take quadratic time. Short texts, for which the
+// calibration does not pay off, get the default threshold.
+template <typename value_type>
+static uint64_t auto_threshold(value_type const* const text,
+                               uint64_t const n) {
+  using namespace internal;
+  if (n < AUTO_THRESHOLD_MIN_N)
+    return DEFAULT_THRESHOLD;
+
+  std::vector<uint64_t> scratch(AUTO_THRESHOLD_WINDOW + 1);
+  uint64_t default_cost = 0;
+  uint64_t best_cost = std::numeric_limits<uint64_t>::max();
+  uint64_t best_threshold = DEFAULT_THRESHOLD;
+  for (uint64_t k = 0; k < std::size(AUTO_THRESHOLD_CANDIDATES); ++k) {
+    const uint64_t cost = window_cost(text, n, k, scratch);
+    if (AUTO_THRESHOLD_CANDIDATES[k] == DEFAULT_THRESHOLD)
+      default_cost = cost;
+    if (cost < best_cost) {
+      best_cost = cost;
+      best_threshold = AUTO_THRESHOLD_CANDIDATES[k];
+    }
+  }
+
+  // only deviate from the default if this is clearly cheaper
+  if (5 * best_cost > 4 * default_cost)
+    return DEFAULT_THRESHOLD;
+  return best_threshold;
+}
+
+} // namespace xss
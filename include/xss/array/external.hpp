@@ -0,0 +1,330 @@
+//  Copyright (c) 2019 Jonas Ellert
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+
+
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <string>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <vector>
+
+#include "xss/common/mapped_text.hpp"
+#include "xss/common/util.hpp"
+#include "xss/common/virtual_sentinels.hpp"
+#include "xss/tree/algorithm.hpp"
+
+namespace xss {
+
+namespace internal {
+
+  // each buffer of the external algorithms takes a quarter of the budget
+  constexpr static uint64_t EXTERNAL_MIN_BUFFER_BYTES = 64ULL * 1024;
+
+  xss_always_inline static uint64_t
+  external_buffer_bytes(const uint64_t mem_budget) {
+    return std::max(mem_budget >> 2, EXTERNAL_MIN_BUFFER_BYTES);
+  }
+
+  inline static bool
+  pwrite_fully(const int fd, const void* data, uint64_t bytes, uint64_t pos) {
+    const char* ptr = (const char*) data;
+    while (bytes > 0) {
+      const ssize_t w = pwrite(fd, ptr, bytes, pos);
+      if (w <= 0)
+        return false;
+      ptr += w;
+      pos += w;
+      bytes -= w;
+    }
+    return true;
+  }
+
+  inline static bool
+  pread_fully(const int fd, void* data, uint64_t bytes, uint64_t pos) {
+    char* ptr = (char*) data;
+    while (bytes > 0) {
+      const ssize_t r = pread(fd, ptr, bytes, pos);
+      if (r <= 0)
+        return false;
+      ptr += r;
+      pos += r;
+      bytes -= r;
+    }
+    return true;
+  }
+
+  // Writes the entries of an array of the given length into a file, either
+  // in increasing or in decreasing order of their indices. Only one window
+  // of entries is buffered.
+  template <typename index_type>
+  class external_array_writer {
+  private:
+    const int fd_;
+    const bool backwards_;
+    std::vector<index_type> buffer_;
+    uint64_t filled_ = 0;
+    // first (or, if backwards, one past the last) index of the window
+    uint64_t window_;
+    bool ok_ = true;
+
+  public:
+    external_array_writer(const int fd,
+                          const uint64_t length,
+                          const uint64_t buffer_bytes,
+                          const bool backwards)
+        : fd_(fd),
+          backwards_(backwards),
+          buffer_(std::max(buffer_bytes / sizeof(index_type), (uint64_t) 1)),
+          window_(backwards ? length : 0) {}
+
+    xss_always_inline void push(const index_type value) {
+      if (backwards_)
+        buffer_[buffer_.size() - ++filled_] = value;
+      else
+        buffer_[filled_++] = value;
+      if (xss_unlikely(filled_ == buffer_.size()))
+        flush();
+    }
+
+    void flush() {
+      const uint64_t bytes = filled_ * sizeof(index_type);
+      if (backwards_) {
+        window_ -= filled_;
+        ok_ &= pwrite_fully(fd_, buffer_.data() + buffer_.size() - filled_,
+                            bytes, window_ * sizeof(index_type));
+      } else {
+        ok_ &= pwrite_fully(fd_, buffer_.data(), bytes,
+                            window_ * sizeof(index_type));
+        window_ += filled_;
+      }
+      filled_ = 0;
+    }
+
+    bool ok() const {
+      return ok_;
+    }
+  };
+
+  // Calls process(bit) for the given bits of a file, either from left to
+  // right or from right to left. Only one chunk of words is buffered.
+  template <typename process_type>
+  static bool scan_bits_file(const int fd,
+                             const uint64_t bits,
+                             const uint64_t buffer_bytes,
+                             const bool backwards,
+                             process_type&& process) {
+    const uint64_t words = (bits + 63) >> 6;
+    const uint64_t chunk_words = std::max(buffer_bytes >> 3, (uint64_t) 1);
+    std::vector<uint64_t> chunk(chunk_words);
+
+    for (uint64_t done = 0; done < words;) {
+      const uint64_t count = std::min(chunk_words, words - done);
+      const uint64_t first = backwards ? (words - done - count) : done;
+      if (!pread_fully(fd, chunk.data(), count << 3, first << 3))
+        return false;
+      const uint64_t begin = first << 6;
+      const uint64_t end = std::min((first + count) << 6, bits);
+      if (backwards) {
+        for (uint64_t idx = end; idx > begin;) {
+          --idx;
+          process((chunk[(idx - begin) >> 6] >> (idx & 63ULL)) & 1ULL, idx);
+        }
+      } else {
+        for (uint64_t idx = begin; idx < end; ++idx)
+          process((chunk[(idx - begin) >> 6] >> (idx & 63ULL)) & 1ULL, idx);
+      }
+      done += count;
+    }
+    return true;
+  }
+
+  // Builds the PSS tree of $text$ (where text is the given file) into an
+  // anonymous temporary file. The BPS is written through a shared mapping,
+  // such that the kernel can write it back whenever memory is short.
+  // Returns the file descriptor (or -1), and sets n to the length of $text$.
+  template <typename index_type>
+  static int external_pss_tree(const std::string& path_in,
+                               const std::string& path_tmp,
+                               const uint64_t mem_budget,
+                               const uint64_t threshold,
+                               uint64_t& n) {
+    const mapped_text text(path_in);
+    if (!text)
+      return -1;
+    n = text.size();
+
+    const int fd = open(path_tmp.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0) {
+      std::cerr << "xss::external --- Cannot create temporary file "
+                << path_tmp << ": " << strerror(errno) << std::endl;
+      return -1;
+    }
+    unlink(path_tmp.c_str());
+
+    // one additional word, which may be written by the stream
+    const uint64_t bytes = ((((n << 1) + 2 + 63) >> 6) + 1) << 3;
+    void* bps = MAP_FAILED;
+    if (ftruncate(fd, bytes) == 0)
+      bps = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (bps == MAP_FAILED) {
+      std::cerr << "xss::external --- Cannot map temporary file " << path_tmp
+                << ": " << strerror(errno) << std::endl;
+      close(fd);
+      return -1;
+    }
+
+    const uint64_t stack_bytes = external_buffer_bytes(mem_budget);
+    if (text.contains_null()) {
+      build_pss_tree<index_type, telescope_stack>(
+          with_virtual_sentinels(text.data() + 1, n - 2), (uint64_t*) bps, n,
+          threshold, no_word_hook(), stack_bytes);
+    } else {
+      build_pss_tree<index_type, telescope_stack>(
+          text.data(), (uint64_t*) bps, n, threshold, no_word_hook(),
+          stack_bytes);
+    }
+    munmap(bps, bytes);
+    return fd;
+  }
+
+  template <bool build_nss, typename index_type>
+  static bool external_array(const std::string& path_in,
+                             const std::string& path_out,
+                             const uint64_t mem_budget,
+                             const uint64_t threshold) {
+    uint64_t n = 0;
+    const int bps_fd = external_pss_tree<index_type>(
+        path_in, path_out + ".bps", mem_budget, threshold, n);
+    if (bps_fd < 0)
+      return false;
+
+    const int out_fd = open(path_out.c_str(), O_WRONLY | O_CREAT | O_TRUNC,
+                            0644);
+    if (out_fd < 0 || ftruncate(out_fd, n * sizeof(index_type)) != 0) {
+      std::cerr << "xss::external --- Cannot create output file " << path_out
+                << ": " << strerror(errno) << std::endl;
+      if (out_fd >= 0)
+        close(out_fd);
+      close(bps_fd);
+      return false;
+    }
+
+    const uint64_t bits = (n << 1) + 2;
+    const uint64_t buffer_bytes = external_buffer_bytes(mem_budget);
+    external_array_writer<index_type> writer(out_fd, n, buffer_bytes,
+                                             build_nss);
+    using stack_type = buffered_stack<telescope_stack, uint64_t>;
+    stack_type stack(buffer_bytes, telescope_stack());
+
+    // The first opening parenthesis belongs to an artificial root. Node i is
+    // represented by the (i + 2)-th opening parenthesis.
+    bool scanned;
+    if constexpr (build_nss) {
+      // From right to left, the stack contains (bits - idx) for the closing
+      // parentheses idx whose matching opening parentheses are not yet known.
+      // The NSS of a node is the first node after its closing parenthesis.
+      uint64_t opening_before = n + 1;
+      scanned = scan_bits_file(
+          bps_fd, bits, buffer_bytes, true,
+          [&](const uint64_t bit, const uint64_t idx) {
+            if (bit == 0) {
+              stack.push(bits - idx);
+              return;
+            }
+            if (--opening_before == 0)
+              return;
+            const uint64_t close_idx = bits - stack.top();
+            stack.pop();
+            // excess before close_idx is the excess before idx plus one
+            const uint64_t excess = 2 * opening_before - idx + 1;
+            writer.push(((close_idx + excess) >> 1) - 1);
+          });
+    } else {
+      // From left to right, the stack contains (i + 1) for the nodes i on the
+      // path from the root to the current node.
+      uint64_t opening_before = 0;
+      scanned = scan_bits_file(
+          bps_fd, bits, buffer_bytes, false,
+          [&](const uint64_t bit, const uint64_t) {
+            if (bit == 0) {
+              if (stack.top() > 0)
+                stack.pop();
+              return;
+            }
+            if (opening_before++ == 0)
+              return;
+            const uint64_t node = opening_before - 2;
+            // children of the root (0 and n - 1) have no PSS
+            writer.push((stack.top() > 0) ? (stack.top() - 1) : n);
+            stack.push(node + 1);
+          });
+    }
+    writer.flush();
+
+    const bool ok = scanned && writer.ok();
+    if (!ok) {
+      std::cerr << "xss::external --- I/O error while writing " << path_out
+                << ": " << strerror(errno) << std::endl;
+    }
+    close(bps_fd);
+    close(out_fd);
+    return ok;
+  }
+
+} // namespace internal
+
+// Semi-external construction for texts that do not fit into memory. The text
+// is mapped into memory and the PSS tree is built into a temporary file next
+// to the output (path_out + ".bps", which is unlinked immediately). Then the
+// array is derived from the tree in a single sequential scan. Apart from the
+// page cache (which the kernel can evict), the memory usage is bounded by
+// mem_budget and the compact telescope stacks. The output file contains the
+// array of $text$ (with n + 2 entries of type index_type, in the byte order
+// of the machine), where text is the content of path_in.
+namespace external {
+
+  template <typename index_type = uint64_t>
+  static bool nss_array(const std::string& path_in,
+                        const std::string& path_out,
+                        const uint64_t mem_budget = 1ULL << 30,
+                        const uint64_t threshold =
+                            internal::DEFAULT_THRESHOLD) {
+    return internal::external_array<true, index_type>(path_in, path_out,
+                                                      mem_budget, threshold);
+  }
+
+  template <typename index_type = uint64_t>
+  static bool pss_array(const std::string& path_in,
+                        const std::string& path_out,
+                        const uint64_t mem_budget = 1ULL << 30,
+                        const uint64_t threshold =
+                            internal::DEFAULT_THRESHOLD) {
+    return internal::external_array<false, index_type>(path_in, path_out,
+                                                       mem_budget, threshold);
+  }
+
+} // namespace external
+} // namespace xss
@@ -20,25 +20,28 @@
 
 #pragma once
 
+#include "xss/common/context.hpp"
 #include "xss/common/util.hpp"
 
 namespace xss {
 namespace internal {
 
   template <typename ctx_type, typename index_type>
-  xss_always_inline static void xss_array_find_pss(const ctx_type& ctx,
+  xss_always_inline static void xss_array_find_pss(ctx_type& ctx,
                                                    const index_type j,
                                                    const index_type i,
                                                    const index_type lce,
                                                    index_type& max_lce_j,
                                                    index_type& max_lce,
                                                    index_type& pss_of_i) {
+    xss_statistics_add(find_pss_calls, 1);
     index_type upper = j;
     index_type upper_lce = lce;
     index_type lower = upper;
     index_type lower_lce = 0;
 
     while (ctx.text[upper + upper_lce] > ctx.text[i + upper_lce]) {
+      xss_statistics_add(find_pss_iterations, 1);
       if (xss_unlikely(lower == upper)) {
         for (index_type k = 0; k < upper_lce; ++k)
           lower = ctx.array[lower];
@@ -50,6 +53,8 @@ namespace internal {
       if (xss_unlikely(lower_lce == upper_lce)) {
         upper = ctx.array[upper];
         upper_lce = ctx.get_lce.with_lower_bound(upper, i, upper_lce);
+        if (lce_truncated(ctx))
+          return;
       } else
         break;
     }
@@ -62,43 +67,52 @@ namespace internal {
       max_lce = upper_lce;
     } else {
       // PSS of i lies between upper and lower (could be lower, but not upper)
-      // we definitely have upper > lower
-      index_type upper_idx = ctx.n - 1;
+      // we definitely have upper > lower, and there are at most upper_lce
+      // elements on the chain from upper to lower (count them, such that the
+      // buffer does not grow with the LCE on periodic texts)
+      index_type chain = 0;
+      for (index_type k = upper; k > lower; k = ctx.array[k])
+        ++chain;
+      index_type* const buffer = ctx.find_pss_buffer(chain + 1);
+      index_type upper_idx = chain;
       index_type lower_idx = upper_idx;
-      ctx.array[upper_idx] = upper;
+      buffer[upper_idx] = upper;
       while (upper > lower) {
-        ctx.array[--lower_idx] = ctx.array[upper];
+        buffer[--lower_idx] = ctx.array[upper];
         upper = ctx.array[upper];
       }
-      upper = ctx.array[upper_idx];
+      upper = buffer[upper_idx];
 
       while (true) {
+        xss_statistics_add(find_pss_iterations, 1);
         // move lower until same LCE as upper
-        lower_lce = ctx.get_lce.with_both_bounds(ctx.array[lower_idx], i,
+        lower_lce = ctx.get_lce.with_both_bounds(buffer[lower_idx], i,
                                                  lower_lce, upper_lce);
         while (lower_lce < upper_lce) {
           ++lower_idx;
-          lower_lce = ctx.get_lce.with_both_bounds(ctx.array[lower_idx], i,
+          lower_lce = ctx.get_lce.with_both_bounds(buffer[lower_idx], i,
                                                    lower_lce, upper_lce);
         }
 
         if (lower_idx == upper_idx) {
-          pss_of_i = ctx.array[lower_idx - 1];
+          pss_of_i = buffer[lower_idx - 1];
           break;
         }
 
         --upper_idx;
         upper_lce =
-            ctx.get_lce.with_lower_bound(ctx.array[upper_idx], i, upper_lce);
+            ctx.get_lce.with_lower_bound(buffer[upper_idx], i, upper_lce);
+        if (lce_truncated(ctx))
+          return;
 
-        if (ctx.text[ctx.array[upper_idx] + upper_lce] <
+        if (ctx.text[buffer[upper_idx] + upper_lce] <
             ctx.text[i + upper_lce]) {
-          pss_of_i = ctx.array[upper_idx];
+          pss_of_i = buffer[upper_idx];
           break;
         }
       }
 
-      max_lce_j = ctx.array[upper_idx];
+      max_lce_j = buffer[upper_idx];
       max_lce = upper_lce;
     }
   }
@@ -0,0 +1,166 @@
+//  Copyright (c) 2019 Jonas Ellert
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+
+#pragma once
+
+#include "xss/common/util.hpp"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace xss {
+namespace internal {
+
+  // Non-owning access to packed integers of the given width (or of a width
+  // that is chosen at runtime, if width is 0). Each access loads/stores one
+  // unaligned word, so the storage needs 9 bytes of padding.
+  template <uint64_t width>
+  struct packed_array {
+    static_assert(width <= 64);
+
+    uint8_t* data = nullptr;
+    uint64_t runtime_width = width;
+
+    struct reference {
+      const packed_array array;
+      const uint64_t idx;
+
+      xss_always_inline operator uint64_t() const {
+        return array.get(idx);
+      }
+
+      xss_always_inline reference& operator=(const uint64_t value) {
+        array.set(idx, value);
+        return *this;
+      }
+
+      xss_always_inline reference& operator=(const reference& other) {
+        return *this = (uint64_t) other;
+      }
+    };
+
+    xss_always_inline uint64_t bits() const {
+      if constexpr (width > 0)
+        return width;
+      else
+        return runtime_width;
+    }
+
+    xss_always_inline uint64_t mask() const {
+      return (bits() < 64) ? ((1ULL << bits()) - 1) : ~0ULL;
+    }
+
+    xss_always_inline uint64_t get(const uint64_t idx) const {
+      const uint64_t bit = idx * bits();
+      const uint64_t shift = bit & 7ULL;
+      const uint8_t* const ptr = data + (bit >> 3);
+      uint64_t word;
+      memcpy(&word, ptr, 8);
+      if constexpr (width > 0 && width % 8 == 0)
+        return word & mask();
+      uint64_t result = word >> shift;
+      if (xss_unlikely(shift + bits() > 64))
+        result |= ((uint64_t) ptr[8]) << (64 - shift);
+      return result & mask();
+    }
+
+    xss_always_inline void set(const uint64_t idx, uint64_t value) const {
+      const uint64_t bit = idx * bits();
+      const uint64_t shift = bit & 7ULL;
+      uint8_t* const ptr = data + (bit >> 3);
+      value &= mask();
+      uint64_t word;
+      memcpy(&word, ptr, 8);
+      word = (word & ~(mask() << shift)) | (value << shift);
+      memcpy(ptr, &word, 8);
+      if constexpr (width == 0 || width % 8 != 0) {
+        if (xss_unlikely(shift + bits() > 64)) {
+          const uint64_t high_mask = mask() >> (64 - shift);
+          ptr[8] = (ptr[8] & ~high_mask) | (value >> (64 - shift));
+        }
+      }
+    }
+
+    xss_always_inline reference operator[](const uint64_t idx) const {
+      return {*this, idx};
+    }
+  };
+
+} // namespace internal
+
+// Array of n integers of the given number of bits. The width can be given as
+// template parameter (40 and 48 bits are byte aligned and thus fastest), or
+// at runtime if the template parameter is 0.
+template <uint64_t fixed_width = 0>
+class int_vector {
+private:
+  uint64_t size_;
+  uint64_t width_;
+  std::vector<uint64_t> data_;
+
+public:
+  using reference = typename internal::packed_array<fixed_width>::reference;
+
+  int_vector(const uint64_t size = 0, const uint64_t bits = fixed_width)
+      : size_(size),
+        width_(fixed_width > 0 ? fixed_width : bits),
+        data_((size_ * width_ + 63) / 64 + 2, 0) {}
+
+  // the smallest width that can represent all values in [0, max_value]
+  static uint64_t required_width(const uint64_t max_value) {
+    return std::max(1, 64 - __builtin_clzll(max_value | 1));
+  }
+
+  internal::packed_array<fixed_width> view() {
+    return {(uint8_t*) data_.data(), width_};
+  }
+
+  uint64_t operator[](const uint64_t idx) const {
+    const internal::packed_array<fixed_width> array{(uint8_t*) data_.data(),
+                                                    width_};
+    return array.get(idx);
+  }
+
+  reference operator[](const uint64_t idx) {
+    return view()[idx];
+  }
+
+  uint64_t size() const {
+    return size_;
+  }
+
+  uint64_t width() const {
+    return width_;
+  }
+
+  uint64_t size_in_bytes() const {
+    return data_.size() * sizeof(uint64_t);
+  }
+
+  uint64_t* data() {
+    return data_.data();
+  }
+
+  const uint64_t* data() const {
+    return data_.data();
+  }
+};
+
+} // namespace xss
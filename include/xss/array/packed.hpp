@@ -0,0 +1,160 @@
+//  Copyright (c) 2019 Jonas Ellert
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+
+#pragma once
+
+#include "algorithm.hpp"
+#include "int_vector.hpp"
+
+namespace xss {
+
+namespace internal {
+
+  template <typename value_type, uint64_t width>
+  struct packed_array_context_type
+      : public array_context_type<uint64_t,
+                                  value_type,
+                                  const value_type*,
+                                  packed_array<width>> {
+
+    std::vector<uint64_t> buffer;
+
+    packed_array_context_type(value_type const* const text,
+                              int_vector<width>& array,
+                              int_vector<width>* const aux,
+                              const uint64_t n)
+        : array_context_type<uint64_t, value_type, const value_type*,
+                             packed_array<width>>{
+              text, array.view(), n,
+              aux ? aux->view() : packed_array<width>()} {}
+
+    // the tail of a packed array cannot be used as unpacked scratch space, so
+    // the buffer holds the longest chain walked by xss_array_find_pss
+    xss_always_inline uint64_t* find_pss_buffer(const uint64_t size) {
+      if (xss_unlikely(buffer.size() < size))
+        buffer.resize(size);
+      return buffer.data();
+    }
+  };
+
+  // Clears the array. If it has fewer than n entries or less than
+  // required_width(n) bits per entry, it is replaced by a large enough one.
+  // Returns false (and leaves the array unchanged) if the fixed width of the
+  // vector is too small.
+  template <uint64_t width>
+  static bool prepare_packed_array(int_vector<width>& array, const uint64_t n) {
+    const uint64_t bits = int_vector<>::required_width(n);
+    if (width > 0 && width < bits)
+      return false;
+    if (array.size() < n || array.width() < bits)
+      array = int_vector<width>(n, std::max(array.width(), bits));
+    else
+      memset(array.data(), 0, array.size_in_bytes());
+    return true;
+  }
+
+  template <bool build_nss,
+            bool build_lyndon,
+            uint64_t width,
+            typename value_type>
+  static bool packed_pss_and_x_array(value_type const* const text,
+                                     int_vector<width>& array,
+                                     int_vector<width>* const aux,
+                                     uint64_t const n,
+                                     uint64_t threshold) {
+    static_assert(!(build_nss && build_lyndon));
+    if (!prepare_packed_array(array, n) ||
+        (aux && !prepare_packed_array(*aux, n)))
+      return false;
+
+    fix_threshold(threshold);
+
+    packed_array_context_type<value_type, width> ctx(text, array, aux, n);
+    run_pss_and_x_array<build_nss, build_lyndon>(ctx, threshold);
+    return true;
+  }
+
+} // namespace internal
+
+// The following overloads write the arrays into packed integer vectors. Vectors
+// with fewer than n entries or less than int_vector<>::required_width(n) bits
+// per entry are replaced by large enough ones. If the fixed width of the
+// vectors is too small, nothing is written and false is returned.
+
+template <uint64_t width, typename value_type>
+static bool pss_array(value_type const* const text,
+                      int_vector<width>& pss,
+                      uint64_t const n,
+                      uint64_t threshold = internal::DEFAULT_THRESHOLD) {
+  return internal::packed_pss_and_x_array<false, false>(
+      text, pss, (int_vector<width>*) nullptr, n, threshold);
+}
+
+template <uint64_t width, typename value_type>
+static bool
+pss_and_nss_array(value_type const* const text,
+                  int_vector<width>& pss,
+                  int_vector<width>& nss,
+                  uint64_t const n,
+                  uint64_t threshold = internal::DEFAULT_THRESHOLD) {
+  return internal::packed_pss_and_x_array<true, false>(text, pss, &nss, n,
+                                                       threshold);
+}
+
+template <uint64_t width, typename value_type>
+static bool
+pss_and_lyndon_array(value_type const* const text,
+                     int_vector<width>& pss,
+                     int_vector<width>& lyndon,
+                     uint64_t const n,
+                     uint64_t threshold = internal::DEFAULT_THRESHOLD) {
+  return internal::packed_pss_and_x_array<false, true>(text, pss, &lyndon, n,
+                                                       threshold);
+}
+
+template <uint64_t width, typename value_type>
+static bool nss_array(value_type const* const text,
+                      int_vector<width>& nss,
+                      uint64_t const n,
+                      uint64_t threshold = internal::DEFAULT_THRESHOLD) {
+  using namespace internal;
+  if (!prepare_packed_array(nss, n))
+    return false;
+  fix_threshold(threshold);
+  packed_array_context_type<value_type, width> ctx(text, nss, nullptr, n);
+  run_nss_array(ctx, threshold);
+  return true;
+}
+
+template <uint64_t width, typename value_type>
+static bool lyndon_array(value_type const* const text,
+                         int_vector<width>& lyndon,
+                         uint64_t const n,
+                         uint64_t threshold = internal::DEFAULT_THRESHOLD) {
+  using namespace internal;
+  if (!prepare_packed_array(lyndon, n))
+    return false;
+  fix_threshold(threshold);
+  packed_array_context_type<value_type, width> ctx(text, lyndon, nullptr, n);
+  run_lyndon_array(ctx, threshold);
+  return true;
+}
+
+} // namespace xss
@@ -0,0 +1,419 @@
+//  Copyright (c) 2019 Jonas Ellert
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+
+#include "algorithm.hpp"
+#include "xss/common/context.hpp"
+#include "xss/common/duval.hpp"
+#include "xss/common/util.hpp"
+#include "xss/common/virtual_sentinels.hpp"
+
+namespace xss {
+
+namespace internal {
+
+  // Each block [begin, end) is processed as if the text started with a
+  // sentinel at begin - 1, which we identify with the actual sentinel at
+  // index 0. Thus, array[i] = 0 means that the PSS of i lies before begin.
+  // The LCE type is initialized from a bounded_lce_type.
+  template <typename index_type,
+            typename value_type,
+            typename array_type = index_type*,
+            typename lce_type_ = bounded_lce_type<index_type, value_type>>
+  struct array_block_context_type
+      : public array_context_type<index_type, value_type, const value_type*,
+                                  array_type, blockwise_anchor, lce_type_> {
+
+    const index_type begin;
+    std::vector<index_type> buffer;
+
+    array_block_context_type(value_type const* const text,
+                             array_type const array,
+                             const index_type n,
+                             const index_type begin,
+                             const index_type end)
+        : array_context_type<index_type, value_type, const value_type*,
+                             array_type, blockwise_anchor, lce_type_>{
+              text, array, n, array_type(),
+              lce_type_{bounded_lce_type<index_type, value_type>{
+                  {text, n}, parallel_block_limit(begin, end, n)}},
+              end},
+          begin(begin) {}
+
+    // the chain from upper to lower lies within the block (or is 0)
+    xss_always_inline index_type* find_pss_buffer(const index_type size) {
+      const index_type capped =
+          std::min(size, (index_type)(this->end - begin + 1));
+      if (xss_unlikely(buffer.size() < capped))
+        buffer.resize(capped);
+      return buffer.data() + capped - size;
+    }
+  };
+
+  // After the scan of a block, the positions whose PSS lies before the block
+  // (the prefix minima of the block) have to be linked, such that array[m]
+  // is the next prefix minimum after m (or 0 for the last one). For NSS and
+  // Lyndon arrays, this link is exactly the (block local) NSS of m. Returns
+  // true if an LCE was cut off, in which case the block is not processed
+  // completely.
+  template <bool build_nss,
+            bool build_lyndon,
+            typename index_type,
+            typename value_type>
+  static bool parallel_array_scan_block(value_type const* const text,
+                                        index_type* const array,
+                                        uint64_t const n,
+                                        uint64_t const begin,
+                                        uint64_t const end,
+                                        uint64_t const threshold) {
+    array_block_context_type<index_type, value_type> ctx(
+        text, array, (index_type) n, (index_type) begin, (index_type) end);
+
+    array[begin] = 0;
+    if constexpr (build_nss)
+      nss_array_scan(ctx, (index_type)(begin + 1), ctx.end, threshold);
+    else if constexpr (build_lyndon)
+      lyndon_array_scan(ctx, (index_type)(begin + 1), ctx.end, threshold);
+    else {
+      pss_and_x_array_scan<false, false>(ctx, (index_type)(begin + 1),
+                                         ctx.end, threshold);
+      if (ctx.get_lce.truncated)
+        return true;
+
+      index_type last_minimum = begin;
+      for (index_type i = begin + 1; i < end; ++i) {
+        if (array[i] == 0) {
+          array[last_minimum] = i;
+          last_minimum = i;
+        }
+      }
+    }
+    return ctx.get_lce.truncated;
+  }
+
+  // Sequentially repairs the pointers that cross from the block [begin, end)
+  // into the preceding blocks. When this is called, everything before begin
+  // is final, and the PSS chain of begin - 1 is the stack of the sequential
+  // algorithm. The LCEs have the same limit as in the scan of the block, but
+  // LCEs that are cut off are completed. Returns true if this happened.
+  template <bool build_nss,
+            bool build_lyndon,
+            typename index_type,
+            typename value_type>
+  static bool parallel_array_merge_block(value_type const* const text,
+                                         index_type* const array,
+                                         uint64_t const n,
+                                         uint64_t const begin,
+                                         uint64_t const end) {
+    const bounded_lce_type<index_type, value_type> bounded_lce{
+        {text, n}, parallel_block_limit(begin, end, n)};
+    const auto get_lce = [&](const index_type l, const index_type r) {
+      const index_type lce = bounded_lce.without_bounds(l, r);
+      if (xss_unlikely(bounded_lce.truncated))
+        return bounded_lce.unbounded.without_bounds(l, r, lce);
+      return lce;
+    };
+
+    index_type top = begin - 1;
+    index_type minimum = begin;
+    while (true) {
+      index_type next_minimum = array[minimum];
+      if constexpr (build_lyndon)
+        next_minimum += (next_minimum > 0) ? minimum : 0;
+
+      index_type lce = get_lce(top, minimum);
+      while (text[top + lce] > text[minimum + lce]) {
+        const index_type next_top = array[top];
+        if constexpr (build_nss)
+          array[top] = minimum;
+        if constexpr (build_lyndon)
+          array[top] = minimum - top;
+        top = next_top;
+        lce = get_lce(top, minimum);
+      }
+
+      if (next_minimum == 0) {
+        array[minimum] = top;
+        return bounded_lce.truncated;
+      }
+      if constexpr (!build_nss && !build_lyndon)
+        array[minimum] = top;
+      minimum = next_minimum;
+    }
+  }
+
+  template <bool build_nss,
+            bool build_lyndon,
+            typename index_type,
+            typename value_type>
+  static void parallel_array(value_type const* const text,
+                             index_type* const array,
+                             uint64_t const n,
+                             uint64_t blocks,
+                             uint64_t const threads,
+                             uint64_t threshold) {
+    static_assert(!(build_nss && build_lyndon));
+    static_assert(std::is_unsigned<index_type>::value);
+    fix_threshold(threshold);
+
+    // positions [1, n - 1) are split into blocks of (almost) equal size
+    const uint64_t inner = n - 2;
+    blocks = std::max((uint64_t) 1, std::min(blocks, inner));
+    const auto block_begin = [&](const uint64_t b) {
+      return 1 + (b * inner) / blocks;
+    };
+
+    array[0] = 0;
+    array[n - 1] = 0;
+
+    std::vector<uint8_t> truncated(blocks);
+#pragma omp parallel for num_threads(threads) schedule(dynamic, 1)
+    for (uint64_t b = 0; b < blocks; ++b) {
+      const uint64_t begin = block_begin(b);
+      const uint64_t end = block_begin(b + 1);
+      memset(&(array[begin]), 0, (end - begin) * sizeof(index_type));
+      truncated[b] = parallel_array_scan_block<build_nss, build_lyndon>(
+          text, array, n, begin, end, threshold);
+    }
+
+    // The blocks are merged up to the first block that was not processed
+    // completely, or whose merge needed long LCEs. The remaining text is
+    // processed sequentially, which keeps the total work linear on
+    // periodic texts.
+    uint64_t sequential_begin = n - 1;
+    if (truncated[0]) {
+      sequential_begin = 1;
+    } else if constexpr (!build_nss && !build_lyndon) {
+      // the first block needs no repair (its prefix minima have PSS 0), but
+      // the links between them have to be replaced
+      for (index_type i = 1; i < block_begin(1);) {
+        const index_type next_minimum = array[i];
+        array[i] = 0;
+        if (next_minimum == 0)
+          break;
+        i = next_minimum;
+      }
+    }
+
+    for (uint64_t b = 1; b < blocks && sequential_begin == n - 1; ++b) {
+      if (truncated[b])
+        sequential_begin = block_begin(b);
+      else if (parallel_array_merge_block<build_nss, build_lyndon>(
+                   text, array, n, block_begin(b), block_begin(b + 1)))
+        sequential_begin = block_begin(b + 1);
+    }
+
+    if (sequential_begin < n - 1) {
+      memset(&(array[sequential_begin]), 0,
+             (n - 1 - sequential_begin) * sizeof(index_type));
+      array_context_type<index_type, value_type> ctx{text, array,
+                                                     (index_type) n};
+      if constexpr (build_nss)
+        nss_array_scan(ctx, (index_type) sequential_begin, ctx.end,
+                       threshold);
+      else if constexpr (build_lyndon)
+        lyndon_array_scan(ctx, (index_type) sequential_begin, ctx.end,
+                          threshold);
+      else
+        pss_and_x_array_scan<false, false>(ctx, (index_type) sequential_begin,
+                                           ctx.end, threshold);
+    }
+
+    if constexpr (build_nss || build_lyndon) {
+      // PROCESS ELEMENTS WITHOUT NSS
+      index_type j = n - 2;
+      while (j > 0) {
+        index_type next_j = array[j];
+        if constexpr (build_nss)
+          array[j] = n - 1;
+        else
+          array[j] = n - j - 1;
+        j = next_j;
+      }
+      array[0] = n - 1;
+      array[n - 1] = (build_nss) ? n : 1;
+    } else {
+      // PSS does not exist <=> pss[i] = n
+      array[0] = array[n - 1] = n;
+    }
+  }
+
+  // Positions in a Lyndon factor have their NSS inside the factor or at the
+  // start of the next factor. Thus, runs of consecutive factors (chunks) can
+  // be processed independently: the NSS and Lyndon arrays of a chunk are the
+  // ones of the chunk on its own, enclosed by (virtual) sentinels. In
+  // particular, no LCE extends beyond the end of its chunk, which would cost
+  // O(n) time per chunk on periodic texts.
+  template <bool build_lyndon, typename index_type, typename value_type>
+  static void factor_parallel_array(value_type const* const text,
+                                    index_type* const array,
+                                    uint64_t const n,
+                                    uint64_t const chunk_size,
+                                    uint64_t const threads,
+                                    uint64_t threshold) {
+    static_assert(std::is_unsigned<index_type>::value);
+    fix_threshold(threshold);
+
+    // chunks end at the first factor boundary after chunk_size characters
+    std::vector<uint64_t> bounds = {1};
+    lyndon_factorization(text, n, [&](const uint64_t i) {
+      if (i - bounds.back() >= chunk_size)
+        bounds.push_back(i);
+    });
+    bounds.push_back(n - 1);
+
+    // largest chunks first, such that small chunks fill the gaps
+    const uint64_t chunks = bounds.size() - 1;
+    std::vector<uint64_t> order(chunks);
+    for (uint64_t c = 0; c < chunks; ++c)
+      order[c] = c;
+    std::sort(order.begin(), order.end(), [&](uint64_t a, uint64_t b) {
+      return bounds[a + 1] - bounds[a] > bounds[b + 1] - bounds[b];
+    });
+
+    // a single dominating factor leaves nothing to parallelize
+    if (bounds[order[0] + 1] - bounds[order[0]] > (n - 2) / 2) {
+      return parallel_array<!build_lyndon, build_lyndon>(
+          text, array, n, parallel_blocks(n, threads), threads, threshold);
+    }
+
+#pragma omp parallel num_threads(threads)
+    {
+      // local arrays of the chunks, including the entries of the sentinels
+      std::vector<index_type> local;
+
+#pragma omp for schedule(dynamic, 1)
+      for (uint64_t c = 0; c < chunks; ++c) {
+        const uint64_t begin = bounds[order[c]];
+        const uint64_t end = bounds[order[c] + 1];
+        const uint64_t m = end - begin + 2;
+        local.assign(m, 0);
+
+        array_context_type<index_type, value_type,
+                           virtual_sentinel_text<value_type>>
+            ctx{with_virtual_sentinels(text + begin, m - 2), local.data(),
+                (index_type) m};
+        if constexpr (build_lyndon) {
+          run_lyndon_array(ctx, threshold);
+          std::copy(local.begin() + 1, local.end() - 1, array + begin);
+        } else {
+          run_nss_array(ctx, threshold);
+          for (uint64_t k = 1; k < m - 1; ++k)
+            array[begin + k - 1] = local[k] + begin - 1;
+        }
+      }
+    }
+
+    array[0] = n - 1;
+    array[n - 1] = (build_lyndon) ? 1 : n;
+  }
+
+  // factor chunks of this size are cut into finer pieces for balancing
+  inline static uint64_t factor_chunk_size(uint64_t const n,
+                                           uint64_t const threads) {
+    return std::max(MIN_PARALLEL_BLOCK_SIZE >> 2, n / (8 * threads));
+  }
+
+} // namespace internal
+
+namespace parallel {
+
+  template <typename index_type, typename value_type>
+  static void pss_array(value_type const* const text,
+                        index_type* const pss,
+                        uint64_t const n,
+                        uint64_t const threads,
+                        uint64_t threshold = internal::DEFAULT_THRESHOLD) {
+    using namespace internal;
+    warn_type_width<index_type>(n, "xss::parallel::pss_array");
+    const uint64_t blocks = parallel_blocks(n, threads);
+    if (blocks < 2)
+      return xss::pss_array(text, pss, n, threshold);
+    parallel_array<false, false>(text, pss, n, blocks, threads, threshold);
+  }
+
+  template <typename index_type, typename value_type>
+  static void nss_array(value_type const* const text,
+                        index_type* const nss,
+                        uint64_t const n,
+                        uint64_t const threads,
+                        uint64_t threshold = internal::DEFAULT_THRESHOLD) {
+    using namespace internal;
+    warn_type_width<index_type>(n, "xss::parallel::nss_array");
+    const uint64_t blocks = parallel_blocks(n, threads);
+    if (blocks < 2)
+      return xss::nss_array(text, nss, n, threshold);
+    parallel_array<true, false>(text, nss, n, blocks, threads, threshold);
+  }
+
+  template <typename index_type, typename value_type>
+  static void lyndon_array(value_type const* const text,
+                           index_type* const lyndon,
+                           uint64_t const n,
+                           uint64_t const threads,
+                           uint64_t threshold = internal::DEFAULT_THRESHOLD) {
+    using namespace internal;
+    warn_type_width<index_type>(n, "xss::parallel::lyndon_array");
+    const uint64_t blocks = parallel_blocks(n, threads);
+    if (blocks < 2)
+      return xss::lyndon_array(text, lyndon, n, threshold);
+    parallel_array<false, true>(text, lyndon, n, blocks, threads, threshold);
+  }
+
+  // Same as nss_array, but parallelized over the Lyndon factorization of the
+  // text. This is beneficial if the text has many (small) Lyndon factors.
+  template <typename index_type, typename value_type>
+  static void
+  nss_array_by_factors(value_type const* const text,
+                       index_type* const nss,
+                       uint64_t const n,
+                       uint64_t const threads,
+                       uint64_t threshold = internal::DEFAULT_THRESHOLD) {
+    using namespace internal;
+    warn_type_width<index_type>(n, "xss::parallel::nss_array_by_factors");
+    if (parallel_blocks(n, threads) < 2)
+      return xss::nss_array(text, nss, n, threshold);
+    factor_parallel_array<false>(text, nss, n, factor_chunk_size(n, threads),
+                                 threads, threshold);
+  }
+
+  // Same as lyndon_array, but parallelized over the Lyndon factorization of
+  // the text. This is beneficial if the text has many (small) Lyndon factors.
+  template <typename index_type, typename value_type>
+  static void
+  lyndon_array_by_factors(value_type const* const text,
+                          index_type* const lyndon,
+                          uint64_t const n,
+                          uint64_t const threads,
+                          uint64_t threshold = internal::DEFAULT_THRESHOLD) {
+    using namespace internal;
+    warn_type_width<index_type>(n, "xss::parallel::lyndon_array_by_factors");
+    if (parallel_blocks(n, threads) < 2)
+      return xss::lyndon_array(text, lyndon, n, threshold);
+    factor_parallel_array<true>(text, lyndon, n,
+                                factor_chunk_size(n, threads), threads,
+                                threshold);
+  }
+
+} // namespace parallel
+} // namespace xss
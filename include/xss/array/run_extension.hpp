@@ -36,8 +36,11 @@ namespace internal {
                           index_type max_lce,
                           const index_type period) {
     bool j_smaller_i = ctx.text[j + max_lce] < ctx.text[i + max_lce];
-    const index_type repetitions = max_lce / period - 1;
+    const index_type repetitions =
+        std::min(max_lce / period - 1, (ctx.end - 1 - i) / period);
     const index_type new_i = i + (repetitions * period);
+    xss_statistics_add(run_extensions, 1);
+    xss_statistics_add(run_extension_entries, repetitions * period);
 
     for (index_type k = i + 1; k < new_i; ++k) {
       ctx.array[k] = ctx.array[k - period] + period;
@@ -76,8 +79,11 @@ namespace internal {
                           index_type max_lce,
                           const index_type period) {
     bool j_smaller_i = ctx.text[j + max_lce] < ctx.text[i + max_lce];
-    const index_type repetitions = max_lce / period - 1;
+    const index_type repetitions =
+        std::min(max_lce / period - 1, (ctx.end - 1 - i) / period);
     const index_type new_i = i + (repetitions * period);
+    xss_statistics_add(run_extensions, 1);
+    xss_statistics_add(run_extension_entries, repetitions * period);
 
     for (index_type k = i + 1; k < new_i; ++k) {
       ctx.array[k] = ctx.array[k - period] + period;
@@ -109,8 +115,11 @@ namespace internal {
                              index_type max_lce,
                              const index_type period) {
     bool j_smaller_i = ctx.text[j + max_lce] < ctx.text[i + max_lce];
-    const index_type repetitions = max_lce / period - 1;
+    const index_type repetitions =
+        std::min(max_lce / period - 1, (ctx.end - 1 - i) / period);
     const index_type new_i = i + (repetitions * period);
+    xss_statistics_add(run_extensions, 1);
+    xss_statistics_add(run_extension_entries, repetitions * period);
 
     for (index_type k = i + 1; k < new_i; ++k) {
       ctx.array[k] = ctx.array[k - period];
@@ -22,18 +22,20 @@
 
 #include "duval.hpp"
 #include "util.hpp"
+#include <cstring>
+#include <type_traits>
 
 namespace xss {
 namespace internal {
 
-  template <typename index_type, typename value_type>
-  xss_always_inline index_type get_anchor(const value_type* lce_str,
+  template <typename index_type, typename text_type>
+  xss_always_inline index_type get_anchor(const text_type lce_str,
                                           const index_type lce_len) {
 
     const index_type ell = lce_len >> 2;
 
     // check if gamm_ell is an extended lyndon run
-    const auto duval = is_extended_lyndon_run(&(lce_str[ell]), lce_len - ell);
+    const auto duval = is_extended_lyndon_run(lce_str + ell, lce_len - ell);
 
     // try to extend the lyndon run as far as possible to the left
     if (duval.first > 0) {
@@ -54,5 +56,72 @@ namespace internal {
     }
   }
 
+  // Length of the longest common suffix of text[.., l) and text[.., r), but
+  // at most limit. Plain texts are compared eight bytes at a time.
+  template <typename text_type>
+  xss_always_inline static uint64_t common_suffix(const text_type text,
+                                                  const uint64_t l,
+                                                  const uint64_t r,
+                                                  const uint64_t limit) {
+    uint64_t result = 0;
+    using value_type = std::remove_cv_t<std::remove_pointer_t<text_type>>;
+    if constexpr (std::is_pointer_v<text_type> &&
+                  std::is_integral_v<value_type> &&
+                  sizeof(value_type) < sizeof(uint64_t)) {
+      constexpr uint64_t block = sizeof(uint64_t) / sizeof(value_type);
+      uint64_t lhs, rhs;
+      while (result + block <= limit) {
+        memcpy(&lhs, &(text[l - result - block]), sizeof(uint64_t));
+        memcpy(&rhs, &(text[r - result - block]), sizeof(uint64_t));
+        if (lhs != rhs)
+          return result +
+                 (__builtin_clzll(lhs ^ rhs) >> 3) / sizeof(value_type);
+        result += block;
+      }
+    }
+    while (result < limit && text[l - result - 1] == text[r - result - 1])
+      ++result;
+    return result;
+  }
+
+  // Same result as get_anchor(ctx.text + i, lce_len), but Duval's algorithm
+  // and the period check use the LCE of the context, and the repetitions are
+  // extended to the left blockwise.
+  template <typename ctx_type, typename index_type>
+  xss_always_inline index_type get_anchor(const ctx_type& ctx,
+                                          const index_type i,
+                                          const index_type lce_len) {
+
+    const index_type ell = lce_len >> 2;
+    const auto duval =
+        is_extended_lyndon_run(ctx.text, ctx.get_lce, i + ell, lce_len - ell);
+    if (duval.first == 0)
+      return ell;
+
+    // the repetitions that end at t and that lie within [0, t)
+    const uint64_t period = duval.first;
+    const uint64_t t = ell + duval.second;
+    const uint64_t repetitions =
+        common_suffix(ctx.text, i + t, i + t + period, t) / period;
+    return std::min((uint64_t) ell, t + period - repetitions * period);
+  }
+
+  // Selects the anchor computation of the lookahead (see the context types).
+  struct duval_anchor {
+    template <typename ctx_type, typename index_type>
+    xss_always_inline static index_type
+    get(const ctx_type& ctx, const index_type i, const index_type lce_len) {
+      return get_anchor(ctx.text + i, lce_len);
+    }
+  };
+
+  struct blockwise_anchor {
+    template <typename ctx_type, typename index_type>
+    xss_always_inline static index_type
+    get(const ctx_type& ctx, const index_type i, const index_type lce_len) {
+      return get_anchor(ctx, i, lce_len);
+    }
+  };
+
 } // namespace internal
 } // namespace xss
\ No newline at end of file
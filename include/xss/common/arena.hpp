@@ -0,0 +1,202 @@
+//  Copyright (c) 2019 Jonas Ellert
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+namespace xss {
+
+// Scratch memory for repeated constructions (e.g. pss_tree(arena&, ...)). The
+// arena is a single block that is handed out front to back. Memory that is
+// given back is reused once all later allocations have been given back as
+// well, so after each construction the arena is empty again and can be reused
+// without any call to malloc or free. If a construction needs more memory
+// than the arena has left, the remaining allocations fall back to malloc and
+// are counted in overflow_bytes().
+// An arena must not be used by multiple threads at the same time.
+class arena {
+public:
+  constexpr static uint64_t alignment = 64;
+  // bookkeeping in front of each allocation
+  constexpr static uint64_t header_bytes = alignment;
+
+  arena() = default;
+
+  // Allocates (and, if prefault, touches) the given number of bytes. If this
+  // fails, the arena is empty and all allocations fall back to malloc.
+  arena(const uint64_t bytes, const bool prefault = true)
+      : block_((uint8_t*) malloc(aligned(bytes) + alignment)) {
+    if (block_ == nullptr)
+      return;
+    memory_ = block_ + (alignment - ((uintptr_t) block_ & (alignment - 1)));
+    capacity_ = aligned(bytes);
+    if (prefault)
+      memset(memory_, 0, capacity_);
+  }
+
+  // Uses the given memory, which is owned by the caller.
+  arena(void* const memory, const uint64_t bytes)
+      : memory_((uint8_t*) memory), capacity_(bytes) {}
+
+  // Each allocation takes header_bytes in addition to the requested bytes.
+  void* allocate(const uint64_t bytes) {
+    const uint64_t size = header_bytes + aligned(bytes);
+    if (size <= capacity_ - used_) {
+      header_type& header = header_at(used_);
+      header.previous = top_;
+      header.released = false;
+      top_ = used_;
+      used_ += size;
+      peak_ = std::max(peak_, used_);
+      return memory_ + top_ + header_bytes;
+    }
+    overflow_bytes_ += aligned(bytes);
+    return malloc(aligned(bytes));
+  }
+
+  // The most recent allocation is given back immediately, any other one as
+  // soon as all later allocations have been given back.
+  void deallocate(void* const pointer, const uint64_t /* bytes */) {
+    uint8_t* const ptr = (uint8_t*) pointer;
+    if (ptr < memory_ || ptr >= memory_ + capacity_) {
+      free(pointer);
+      return;
+    }
+    header_at(ptr - header_bytes - memory_).released = true;
+    while (top_ != none && header_at(top_).released) {
+      used_ = top_;
+      top_ = header_at(top_).previous;
+    }
+  }
+
+  // Grows the most recent allocation in place (returns false if this is not
+  // possible).
+  bool extend(void* const pointer,
+              const uint64_t /* bytes */,
+              const uint64_t new_bytes) {
+    uint8_t* const ptr = (uint8_t*) pointer;
+    if (ptr < memory_ || ptr >= memory_ + capacity_ || top_ == none ||
+        ptr != memory_ + top_ + header_bytes ||
+        header_bytes + aligned(new_bytes) > capacity_ - top_)
+      return false;
+    used_ = top_ + header_bytes + aligned(new_bytes);
+    peak_ = std::max(peak_, used_);
+    return true;
+  }
+
+  // Releases all allocations at once.
+  void reset() {
+    used_ = 0;
+    top_ = none;
+  }
+
+  uint64_t capacity() const {
+    return capacity_;
+  }
+
+  uint64_t used() const {
+    return used_;
+  }
+
+  uint64_t peak() const {
+    return peak_;
+  }
+
+  // total bytes that did not fit into the arena
+  uint64_t overflow_bytes() const {
+    return overflow_bytes_;
+  }
+
+  arena& operator=(arena&& other) {
+    std::swap(memory_, other.memory_);
+    std::swap(capacity_, other.capacity_);
+    std::swap(used_, other.used_);
+    std::swap(top_, other.top_);
+    std::swap(peak_, other.peak_);
+    std::swap(overflow_bytes_, other.overflow_bytes_);
+    std::swap(block_, other.block_);
+    return (*this);
+  }
+
+  arena(arena&& other) {
+    (*this) = std::move(other);
+  }
+
+  arena(const arena&) = delete;
+  arena& operator=(const arena&) = delete;
+
+  ~arena() {
+    free(block_);
+  }
+
+private:
+  // the allocated block (nullptr if the memory is owned by the caller)
+  uint8_t* block_ = nullptr;
+  uint8_t* memory_ = nullptr;
+  uint64_t capacity_ = 0;
+  uint64_t used_ = 0;
+  uint64_t peak_ = 0;
+  uint64_t overflow_bytes_ = 0;
+
+  // The allocations form a list from the most recent one (at offset top_)
+  // backwards, such that allocations that were given back out of order can
+  // be reclaimed later.
+  struct alignas(alignment) header_type {
+    uint64_t previous;
+    bool released;
+  };
+  static_assert(sizeof(header_type) == header_bytes);
+  constexpr static uint64_t none = ~0ULL;
+  uint64_t top_ = none;
+
+  header_type& header_at(const uint64_t offset) {
+    return *((header_type*) (memory_ + offset));
+  }
+
+  constexpr static uint64_t aligned(const uint64_t bytes) {
+    return (bytes + alignment - 1) & ~(alignment - 1);
+  }
+};
+
+namespace internal {
+
+  // Scratch memory from the arena, or from the heap if there is no arena.
+  inline static void* allocate_scratch(arena* const scratch,
+                                       const uint64_t bytes) {
+    return scratch ? scratch->allocate(bytes) : malloc(bytes);
+  }
+
+  inline static void free_scratch(arena* const scratch,
+                                  void* const pointer,
+                                  const uint64_t bytes) {
+    if (scratch)
+      scratch->deallocate(pointer, bytes);
+    else
+      free(pointer);
+  }
+
+} // namespace internal
+} // namespace xss
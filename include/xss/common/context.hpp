@@ -20,6 +20,8 @@
 
 #pragma once
 
+#include "anchor.hpp"
+#include "arena.hpp"
 #include "lce.hpp"
 #include "util.hpp"
 #include "xss/tree/bit_vector.hpp"
@@ -27,31 +29,69 @@
 namespace xss {
 namespace internal {
 
-  template <typename index_type, typename value_type>
+  template <typename index_type,
+            typename value_type,
+            typename text_type = const value_type*,
+            typename array_type = index_type*,
+            typename anchor_type_ = blockwise_anchor,
+            typename lce_type_ = lce_type<index_type, value_type, text_type>>
   struct array_context_type {
+    // computes the anchors of the lookahead (see anchor.hpp)
+    using anchor_type = anchor_type_;
 
-    const value_type* text;
-    index_type* array;
+    text_type text;
+    array_type array;
     const index_type n;
 
-    index_type* aux = nullptr;
+    array_type aux = array_type();
 
-    const lce_type<index_type, value_type> get_lce =
-        lce_type<index_type, value_type>{text};
+    const lce_type_ get_lce = lce_type_{text, n};
+
+    // run extensions and lookaheads never advance beyond end - 1
+    const index_type end = n - 1;
+
+    // scratch space for xss_array_find_pss (the unused tail of the array)
+    xss_always_inline index_type* find_pss_buffer(const index_type size) {
+      return array + n - size;
+    }
   };
 
-  template <typename stack_type, typename index_type, typename value_type>
+  template <typename stack_type,
+            typename index_type,
+            typename value_type,
+            typename text_type = const value_type*,
+            typename stream_type = parentheses_stream,
+            typename anchor_type_ = blockwise_anchor,
+            typename lce_type_ = lce_type<index_type, value_type, text_type>>
   struct tree_context_type {
+    // computes the anchors of the lookahead (see anchor.hpp)
+    using anchor_type = anchor_type_;
 
-    const value_type* text;
-    bit_vector& bv;
-    parentheses_stream& stream;
+    text_type text;
+    stream_type& stream;
     stack_type& stack;
     const index_type n;
 
-    const lce_type<index_type, value_type> get_lce =
-        lce_type<index_type, value_type>{text};
+    const lce_type_ get_lce = lce_type_{text, n};
+
+    // run extensions and lookaheads never advance beyond end - 1
+    const index_type end = n - 1;
+
+    // scratch memory of pss_tree_find_pss (nullptr: heap)
+    arena* scratch = nullptr;
   };
 
+  // Contexts with a bounded_lce_type stop scanning as soon as an LCE was cut
+  // off, because the remaining results would not be reliable. For all other
+  // contexts, this is false at compile time.
+  template <typename ctx_type>
+  xss_always_inline static bool lce_truncated(const ctx_type& ctx) {
+    using get_lce_type = std::remove_const_t<decltype(ctx.get_lce)>;
+    if constexpr (is_bounded_lce<get_lce_type>::value)
+      return xss_unlikely(ctx.get_lce.truncated);
+    else
+      return false;
+  }
+
 } // namespace internal
 } // namespace xss
\ No newline at end of file
@@ -21,13 +21,15 @@
 #pragma once
 
 #include "util.hpp"
+#include <cstring>
+#include <type_traits>
 
 namespace xss {
 namespace internal {
 
-  template <typename value_type>
+  template <typename text_type>
   xss_always_inline static std::pair<uint64_t, uint64_t>
-  is_extended_lyndon_run(const value_type* text, const uint64_t n) {
+  is_extended_lyndon_run(const text_type text, const uint64_t n) {
     std::pair<uint64_t, uint64_t> result = {0, 0};
     uint64_t i = 0;
     while (i < n) {
@@ -57,5 +59,99 @@ namespace internal {
     return result;
   }
 
+  // Same as is_extended_lyndon_run(text + base, n), but runs of equal
+  // characters in Duval's algorithm and the final check of the period are
+  // handled by (blockwise) LCE queries.
+  template <typename text_type, typename lce_type>
+  xss_always_inline static std::pair<uint64_t, uint64_t>
+  is_extended_lyndon_run(const text_type text,
+                         const lce_type& get_lce,
+                         const uint64_t base,
+                         const uint64_t n) {
+    std::pair<uint64_t, uint64_t> result = {0, 0};
+    uint64_t i = 0;
+    while (i < n) {
+      uint64_t j = i + 1, k = i;
+      while (j < n && text[base + k] <= text[base + j]) {
+        if (text[base + k] < text[base + j]) {
+          k = i;
+          ++j;
+        } else {
+          const uint64_t lce =
+              get_lce.with_both_bounds(base + k, base + j, 1, n - j);
+          k += lce;
+          j += lce;
+        }
+      }
+      if (xss_unlikely((j - k) > result.first)) {
+        result.first = j - k;
+        result.second = i;
+      }
+      while (i <= k) {
+        i += j - k;
+      }
+    }
+    const uint64_t period = result.first;
+    if (2 * period > n ||
+        get_lce.with_upper_bound(base, base + period, n - period) <
+            n - period)
+      return {0, 0};
+    return result;
+  }
+
+  // Length of the longest common prefix of text[l, n) and text[r, n) for
+  // l < r, comparing eight bytes at a time.
+  template <typename value_type>
+  xss_always_inline static uint64_t blocked_lcp(const value_type* text,
+                                                const uint64_t l,
+                                                const uint64_t r,
+                                                const uint64_t n) {
+    uint64_t lcp = 0;
+    if constexpr (std::is_integral<value_type>::value &&
+                  sizeof(value_type) < sizeof(uint64_t)) {
+      constexpr uint64_t block = sizeof(uint64_t) / sizeof(value_type);
+      uint64_t lhs, rhs;
+      while (r + lcp + block <= n) {
+        memcpy(&lhs, &(text[l + lcp]), sizeof(uint64_t));
+        memcpy(&rhs, &(text[r + lcp]), sizeof(uint64_t));
+        if (lhs != rhs)
+          return lcp + (__builtin_ctzll(lhs ^ rhs) >> 3) / sizeof(value_type);
+        lcp += block;
+      }
+    }
+    while (r + lcp < n && text[l + lcp] == text[r + lcp])
+      ++lcp;
+    return lcp;
+  }
+
+  // Duval's algorithm for the Lyndon factorization of text[1, n - 1), where
+  // text[0] and text[n - 1] are sentinels. Calls report(i) for the starting
+  // position i of each factor (in increasing order). Runs of equal
+  // characters are skipped block-wise.
+  template <typename value_type, typename report_type>
+  static void lyndon_factorization(const value_type* text,
+                                   const uint64_t n,
+                                   report_type&& report) {
+    uint64_t i = 1;
+    while (i < n - 1) {
+      uint64_t j = i + 1, k = i;
+      // the sentinel at n - 1 terminates the loop
+      while (text[k] <= text[j]) {
+        if (text[k] < text[j]) {
+          k = i;
+          ++j;
+        } else {
+          const uint64_t lcp = blocked_lcp(text, k, j, n);
+          k += lcp;
+          j += lcp;
+        }
+      }
+      while (i <= k) {
+        report(i);
+        i += j - k;
+      }
+    }
+  }
+
 } // namespace internal
 } // namespace xss
\ No newline at end of file
@@ -0,0 +1,303 @@
+//  Copyright (c) 2019 Jonas Ellert
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <utility>
+
+namespace xss {
+
+// Pages that back a large_buffer. With transparent, the buffer is aligned to
+// 2MiB and the kernel is asked (madvise) to use transparent huge pages.
+// huge_2m and huge_1g use explicit huge pages (MAP_HUGETLB), which must be
+// reserved beforehand (e.g. /sys/kernel/mm/hugepages/*/nr_hugepages). If there
+// are not enough of them, the buffer falls back to transparent huge pages.
+enum class page_size { standard, transparent, huge_2m, huge_1g };
+
+// NUMA placement of a large_buffer: the kernel default (pages are placed on
+// the node of the thread that touches them first), the node of the allocating
+// thread, or interleaved over all nodes (e.g. for parallel constructions).
+enum class numa_placement { first_touch, local, interleave };
+
+struct memory_options {
+  page_size pages = page_size::standard;
+  numa_placement numa = numa_placement::first_touch;
+  // touch all pages in the constructor
+  bool populate = false;
+};
+
+// Anonymous memory mapping for large outputs, e.g.
+//   xss::large_buffer result(n * sizeof(uint32_t), {xss::page_size::huge_2m});
+//   xss::lyndon_array(text, result.data<uint32_t>(), n);
+// Random accesses to multi-GB outputs (the PSS chains of the arrays, and the
+// bits read by the lookahead of the tree) cause a dTLB miss for almost every
+// access with 4KiB pages, and far fewer with huge pages. The memory is not
+// initialized unless options.populate is set, in which case it is zero.
+class large_buffer {
+public:
+  large_buffer() = default;
+
+  large_buffer(const uint64_t bytes, const memory_options options = {})
+      : pages_(options.pages), numa_(options.numa) {
+    if (bytes == 0)
+      return;
+
+    if (pages_ == page_size::huge_2m || pages_ == page_size::huge_1g) {
+      if (!map_hugetlb(bytes)) {
+        warn_once(hugetlb_warned(), "Not enough huge pages of the requested "
+                                    "size, using transparent huge pages.");
+        pages_ = page_size::transparent;
+      }
+    }
+
+    if (mapping_ == nullptr) {
+      const uint64_t align =
+          (pages_ == page_size::transparent) ? huge_2m_bytes : 0;
+      if (!map_standard(bytes, align)) {
+        std::cerr << "xss::large_buffer --- Cannot map " << bytes
+                  << " bytes: " << strerror(errno) << std::endl;
+        return;
+      }
+#ifdef MADV_HUGEPAGE
+      if (pages_ == page_size::transparent &&
+          madvise(mapping_, size_, MADV_HUGEPAGE) != 0) {
+        warn_once(thp_warned(), "Transparent huge pages are not available.");
+        pages_ = page_size::standard;
+      }
+#else
+      pages_ = page_size::standard;
+#endif
+    }
+
+    if (numa_ != numa_placement::first_touch && !place()) {
+      warn_once(numa_warned(), "Cannot set the NUMA placement (" +
+                                   std::string(strerror(errno)) + ").");
+      numa_ = numa_placement::first_touch;
+    }
+
+    if (options.populate) {
+      // the pages are placed according to the NUMA policy when touched
+      volatile uint8_t* const memory = mapping_;
+      for (uint64_t i = 0; i < size_; i += 4096)
+        memory[i] = 0;
+    }
+  }
+
+  large_buffer(const large_buffer&) = delete;
+  large_buffer& operator=(const large_buffer&) = delete;
+
+  large_buffer(large_buffer&& other) {
+    *this = std::move(other);
+  }
+
+  large_buffer& operator=(large_buffer&& other) {
+    std::swap(mapping_, other.mapping_);
+    std::swap(size_, other.size_);
+    std::swap(pages_, other.pages_);
+    std::swap(numa_, other.numa_);
+    return *this;
+  }
+
+  ~large_buffer() {
+    if (mapping_ != nullptr)
+      munmap(mapping_, size_);
+  }
+
+  template <typename value_type = uint8_t>
+  value_type* data() {
+    return (value_type*) mapping_;
+  }
+
+  template <typename value_type = uint8_t>
+  const value_type* data() const {
+    return (const value_type*) mapping_;
+  }
+
+  // size of the mapping in bytes (at least the requested size)
+  uint64_t size() const {
+    return size_;
+  }
+
+  // The pages and the placement that were actually obtained. Note that
+  // transparent huge pages are only a hint to the kernel.
+  page_size pages() const {
+    return pages_;
+  }
+
+  numa_placement numa() const {
+    return numa_;
+  }
+
+  explicit operator bool() const {
+    return mapping_ != nullptr;
+  }
+
+private:
+  constexpr static uint64_t huge_2m_bytes = 1ULL << 21;
+  constexpr static uint64_t huge_1g_bytes = 1ULL << 30;
+
+  uint8_t* mapping_ = nullptr;
+  uint64_t size_ = 0;
+  page_size pages_ = page_size::standard;
+  numa_placement numa_ = numa_placement::first_touch;
+
+  constexpr static uint64_t round_up(const uint64_t bytes,
+                                     const uint64_t page) {
+    return (bytes + page - 1) & ~(page - 1);
+  }
+
+  bool map_hugetlb(const uint64_t bytes) {
+#if defined(MAP_HUGETLB) && defined(MAP_HUGE_SHIFT)
+    const bool gigantic = (pages_ == page_size::huge_1g);
+    const uint64_t page = gigantic ? huge_1g_bytes : huge_2m_bytes;
+    const int page_flag = (gigantic ? 30 : 21) << MAP_HUGE_SHIFT;
+    const uint64_t size = round_up(bytes, page);
+    void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | page_flag,
+                      -1, 0);
+    if (base == MAP_FAILED)
+      return false;
+    mapping_ = (uint8_t*) base;
+    size_ = size;
+    return true;
+#else
+    (void) bytes;
+    return false;
+#endif
+  }
+
+  // Maps the given number of bytes, aligned to align bytes (if align > 0).
+  bool map_standard(const uint64_t bytes, const uint64_t align) {
+    const uint64_t size = round_up(bytes, sysconf(_SC_PAGESIZE));
+    void* base = mmap(nullptr, size + align, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED)
+      return false;
+    uint8_t* begin = (uint8_t*) base;
+    if (align > 0) {
+      // unmap the unaligned head and the remaining tail
+      uint8_t* aligned = (uint8_t*) round_up((uintptr_t) begin, align);
+      if (aligned > begin)
+        munmap(begin, aligned - begin);
+      if (aligned < begin + align)
+        munmap(aligned + size, (begin + align) - aligned);
+      begin = aligned;
+    }
+    mapping_ = begin;
+    size_ = size;
+    return true;
+  }
+
+  // Sets the NUMA policy with mbind (numaif.h belongs to libnuma, so the
+  // system call is used directly).
+  bool place() const {
+#ifdef SYS_mbind
+    constexpr static int mpol_preferred = 1;
+    constexpr static int mpol_interleave = 3;
+    if (numa_ == numa_placement::local) {
+      // preferred without nodes means the node of the allocating thread
+      return syscall(SYS_mbind, mapping_, size_, mpol_preferred, nullptr, 0,
+                     0) == 0;
+    }
+    const unsigned long nodes = online_nodes();
+    return syscall(SYS_mbind, mapping_, size_, mpol_interleave, &nodes,
+                   sizeof(nodes) * 8 + 1, 0) == 0;
+#else
+    errno = ENOSYS;
+    return false;
+#endif
+  }
+
+  // Bit mask of the (first 64) online nodes, e.g. "0-3,6" yields 0b1001111.
+  static unsigned long online_nodes() {
+    unsigned long result = 0;
+    FILE* file = fopen("/sys/devices/system/node/online", "r");
+    if (file != nullptr) {
+      unsigned first, last;
+      int count;
+      while ((count = fscanf(file, "%u-%u", &first, &last)) >= 1) {
+        if (count == 1)
+          last = first;
+        for (unsigned node = first; node <= last && node < 64; ++node)
+          result |= 1UL << node;
+        if (fgetc(file) != ',')
+          break;
+      }
+      fclose(file);
+    }
+    return (result > 0) ? result : 1;
+  }
+
+  static bool& hugetlb_warned() {
+    static bool warned = false;
+    return warned;
+  }
+
+  static bool& thp_warned() {
+    static bool warned = false;
+    return warned;
+  }
+
+  static bool& numa_warned() {
+    static bool warned = false;
+    return warned;
+  }
+
+  static void warn_once(bool& warned, const std::string& message) {
+    if (!warned)
+      std::cerr << "xss::large_buffer --- " << message << std::endl;
+    warned = true;
+  }
+};
+
+[[maybe_unused]] static std::string to_string(const page_size pages) {
+  switch (pages) {
+  case page_size::transparent:
+    return "thp";
+  case page_size::huge_2m:
+    return "2m";
+  case page_size::huge_1g:
+    return "1g";
+  default:
+    return "standard";
+  }
+}
+
+[[maybe_unused]] static std::string to_string(const numa_placement numa) {
+  switch (numa) {
+  case numa_placement::local:
+    return "local";
+  case numa_placement::interleave:
+    return "interleave";
+  default:
+    return "first-touch";
+  }
+}
+
+} // namespace xss
@@ -21,19 +21,121 @@
 #pragma once
 
 #include "util.hpp"
+#include "virtual_sentinels.hpp"
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#if defined(__AVX2__) || defined(__AVX512BW__)
+#include <immintrin.h>
+#endif
 
 namespace xss {
 namespace internal {
 
-  template <typename index_type, typename value_type>
+  template <typename index_type,
+            typename value_type,
+            typename text_type = const value_type*>
   struct lce_type {
-    const value_type* text;
+    text_type text;
+    // length of the text (blocks are only compared if it is known)
+    uint64_t n = 0;
+
+    // virtual sentinels cannot be compared blockwise, so blocks must lie
+    // within [1, n - 1) in this case
+    constexpr static uint64_t block_gap =
+        text_traits<text_type>::virtual_sentinels ? 1 : 0;
+
+    xss_always_inline const char* block_pointer(const uint64_t i) const {
+      if constexpr (text_traits<text_type>::virtual_sentinels)
+        return (const char*) &(text.raw[text.offset + i - 1]);
+      else
+        return (const char*) &(text[i]);
+    }
+
+    // Blocks are compared bytewise, which is exact for integer characters
+    // (the first mismatching byte lies in the first mismatching character).
+    constexpr static uint64_t char_bytes = sizeof(value_type);
+    constexpr static bool blockwise =
+        std::is_integral_v<value_type> &&
+        (char_bytes == 1 || char_bytes == 2 || char_bytes == 4);
+    constexpr static uint64_t log_char_bytes =
+        (char_bytes == 4) ? 2 : ((char_bytes == 2) ? 1 : 0);
+
+    // Compares blocks of characters that fit into [lower, upper) and returns
+    // the first mismatching index (or the first index that was not checked).
+    xss_always_inline uint64_t compare_blocks(const uint64_t l,
+                                              const uint64_t r,
+                                              const uint64_t lower_idx,
+                                              const uint64_t upper_idx) const {
+      const char* lhs = block_pointer(l);
+      const char* rhs = block_pointer(r);
+      uint64_t lower = lower_idx << log_char_bytes;
+      const uint64_t upper = upper_idx << log_char_bytes;
+      uint64_t lhs_word, rhs_word;
+      const auto compare_word = [&]() {
+        memcpy(&lhs_word, lhs + lower, 8);
+        memcpy(&rhs_word, rhs + lower, 8);
+        return lhs_word == rhs_word;
+      };
+      const auto mismatch_in_word = [&]() {
+        return (lower + (__builtin_ctzll(lhs_word ^ rhs_word) >> 3)) >>
+               log_char_bytes;
+      };
+
+      // most LCEs are short, so try a single word first
+      if (lower + 8 <= upper) {
+        if (!compare_word())
+          return mismatch_in_word();
+        lower += 8;
+      }
+#if defined(__AVX512BW__)
+      while (lower + 64 <= upper) {
+        const __m512i lhs_block = _mm512_loadu_si512(lhs + lower);
+        const __m512i rhs_block = _mm512_loadu_si512(rhs + lower);
+        const uint64_t mask = _mm512_cmpneq_epi8_mask(lhs_block, rhs_block);
+        if (mask)
+          return (lower + __builtin_ctzll(mask)) >> log_char_bytes;
+        lower += 64;
+      }
+#elif defined(__AVX2__)
+      while (lower + 32 <= upper) {
+        const __m256i lhs_block =
+            _mm256_loadu_si256((const __m256i*) (lhs + lower));
+        const __m256i rhs_block =
+            _mm256_loadu_si256((const __m256i*) (rhs + lower));
+        const uint32_t mask = ~((uint32_t) _mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(lhs_block, rhs_block)));
+        if (mask)
+          return (lower + __builtin_ctz(mask)) >> log_char_bytes;
+        lower += 32;
+      }
+#endif
+      while (lower + 8 <= upper) {
+        if (!compare_word())
+          return mismatch_in_word();
+        lower += 8;
+      }
+      return lower >> log_char_bytes;
+    }
 
     xss_always_inline index_type without_bounds(const index_type l,
                                                 const index_type r,
                                                 index_type lce = 0) const {
+      xss_statistics_add(lce_calls, 1);
+      [[maybe_unused]] const index_type lower = lce;
+      if constexpr (blockwise) {
+        if (text[l + lce] != text[r + lce]) {
+          xss_statistics_add(lce_characters, 1);
+          return lce;
+        }
+        const uint64_t right = std::max(l, r);
+        if (right + lce + block_gap < n && std::min(l, r) >= block_gap)
+          lce = compare_blocks(l, r, lce + 1, n - block_gap - right);
+      }
       while (text[l + lce] == text[r + lce])
         ++lce;
+      xss_statistics_add(lce_characters, lce - lower + 1);
       return lce;
     }
 
@@ -42,8 +144,20 @@ namespace internal {
                      const index_type r,
                      index_type lower,
                      const index_type upper) const {
+      xss_statistics_add(lce_calls, 1);
+      [[maybe_unused]] const index_type initial_lower = lower;
+      if constexpr (blockwise) {
+        const uint64_t right = std::max(l, r);
+        const uint64_t end = (std::min(l, r) >= block_gap) ? n - block_gap : 0;
+        const uint64_t limit =
+            std::min((uint64_t) upper, (right < end) ? (end - right) : 0);
+        if (lower < limit)
+          lower = compare_blocks(l, r, lower, limit);
+      }
       while (lower < upper && text[l + lower] == text[r + lower])
         ++lower;
+      xss_statistics_add(lce_characters,
+                         lower - initial_lower + ((lower < upper) ? 1 : 0));
       return lower;
     }
 
@@ -58,5 +172,75 @@ namespace internal {
     }
   };
 
+  // LCE queries that do not compare characters at or beyond text[limit]. If
+  // a query is cut off by the limit, its result is only a lower bound of the
+  // LCE and truncated is set. The blocks of the parallel algorithms use this
+  // to detect LCEs that reach far beyond the block (e.g. on periodic texts).
+  template <typename index_type, typename value_type>
+  struct bounded_lce_type {
+    lce_type<index_type, value_type> unbounded;
+    uint64_t limit;
+    mutable bool truncated = false;
+
+    xss_always_inline index_type
+    with_both_bounds(const index_type l,
+                     const index_type r,
+                     const index_type lower,
+                     const index_type upper) const {
+      const uint64_t right = std::max(l, r);
+      const uint64_t cap = (right < limit) ? (limit - right) : 0;
+      if (xss_likely(upper <= cap))
+        return unbounded.with_both_bounds(l, r, lower, upper);
+      if (xss_unlikely(lower >= cap)) {
+        truncated = true;
+        return lower;
+      }
+      const index_type result = unbounded.with_both_bounds(l, r, lower, cap);
+      if (xss_unlikely(result == cap))
+        truncated = true;
+      return result;
+    }
+
+    xss_always_inline index_type without_bounds(const index_type l,
+                                                const index_type r,
+                                                index_type lce = 0) const {
+      const uint64_t right = std::max(l, r);
+      const uint64_t cap = (right < limit) ? (limit - right) : 0;
+      if (xss_unlikely(lce >= cap)) {
+        truncated = true;
+        return lce;
+      }
+      // most LCEs end at the first character
+      if (unbounded.text[l + lce] != unbounded.text[r + lce]) {
+        xss_statistics_add(lce_calls, 1);
+        xss_statistics_add(lce_characters, 1);
+        return lce;
+      }
+      const index_type result =
+          unbounded.with_both_bounds(l, r, lce + 1, cap);
+      xss_statistics_add(lce_characters, 1);
+      if (xss_unlikely(result == cap))
+        truncated = true;
+      return result;
+    }
+
+    xss_always_inline index_type with_upper_bound(
+        const index_type l, const index_type r, const index_type upper) const {
+      return with_both_bounds(l, r, 0, upper);
+    }
+
+    xss_always_inline index_type with_lower_bound(
+        const index_type l, const index_type r, const index_type lower) const {
+      return without_bounds(l, r, lower);
+    }
+  };
+
+  template <typename lce_type>
+  struct is_bounded_lce : std::false_type {};
+
+  template <typename index_type, typename value_type>
+  struct is_bounded_lce<bounded_lce_type<index_type, value_type>>
+      : std::true_type {};
+
 } // namespace internal
 } // namespace xss
\ No newline at end of file
@@ -0,0 +1,179 @@
+//  Copyright (c) 2019 Jonas Ellert
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+
+
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+namespace xss {
+
+// Read-only, memory-mapped text with virtual sentinels. The file is mapped
+// directly behind an anonymous zero page, such that data()[0] is the last byte
+// of that page and data()[size() - 1] is the first byte after the mapped file.
+// Only the final partial page of the file is copied (into anonymous memory),
+// all other pages are shared with the page cache.
+// The sentinels are only valid if the file contains no null-characters, which
+// can be checked with contains_null().
+// With sequential, the kernel is advised (MADV_SEQUENTIAL) to read ahead
+// aggressively and to drop pages soon after they were read. This only pays
+// off for single forward passes (e.g. computing the alphabet or the Lyndon
+// factorization). The constructions compare suffixes with earlier text, which
+// would then be read from the file again.
+class mapped_text {
+public:
+  mapped_text() = default;
+
+  mapped_text(const std::string& file_name,
+              uint64_t const prefix_size = 0,
+              bool const populate = false,
+              bool const sequential = false) {
+    const int fd = open(file_name.c_str(), O_RDONLY);
+    if (fd < 0) {
+      std::cerr << "xss::mapped_text --- Cannot open file " << file_name
+                << "." << std::endl;
+      return;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+      close(fd);
+      return;
+    }
+
+    uint64_t length = st.st_size;
+    if (prefix_size > 0)
+      length = std::min(length, prefix_size);
+
+    const uint64_t page = sysconf(_SC_PAGESIZE);
+    const uint64_t full_pages = length - (length % page);
+    const uint64_t tail = length - full_pages;
+
+    // [zero page][full pages of the file][tail of the file + zeros]
+    mapping_size_ = page + full_pages + page;
+    void* base = mmap(nullptr, mapping_size_, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (base == MAP_FAILED) {
+      report_failure(fd, file_name);
+      return;
+    }
+    mapping_ = (uint8_t*) base;
+
+    if (full_pages > 0) {
+      int flags = MAP_PRIVATE | MAP_FIXED;
+#ifdef MAP_POPULATE
+      if (populate)
+        flags |= MAP_POPULATE;
+#endif
+      if (mmap(mapping_ + page, full_pages, PROT_READ, flags, fd, 0) ==
+          MAP_FAILED) {
+        report_failure(fd, file_name);
+        return;
+      }
+      if (sequential)
+        madvise(mapping_ + page, full_pages, MADV_SEQUENTIAL);
+    }
+
+    for (uint64_t read = 0; read < tail;) {
+      const ssize_t r = pread(fd, mapping_ + page + full_pages + read,
+                              tail - read, full_pages + read);
+      if (r <= 0) {
+        report_failure(fd, file_name);
+        return;
+      }
+      read += r;
+    }
+    mprotect(mapping_ + page + full_pages, page, PROT_READ);
+    mprotect(mapping_, page, PROT_READ);
+    close(fd);
+
+    text_ = mapping_ + page - 1;
+    n_ = length + 2;
+  }
+
+  mapped_text(const mapped_text&) = delete;
+  mapped_text& operator=(const mapped_text&) = delete;
+
+  mapped_text(mapped_text&& other) {
+    *this = std::move(other);
+  }
+
+  mapped_text& operator=(mapped_text&& other) {
+    std::swap(mapping_, other.mapping_);
+    std::swap(mapping_size_, other.mapping_size_);
+    std::swap(text_, other.text_);
+    std::swap(n_, other.n_);
+    return *this;
+  }
+
+  ~mapped_text() {
+    unmap();
+  }
+
+  // text including both sentinels
+  const uint8_t* data() const {
+    return text_;
+  }
+
+  // length of the text including both sentinels
+  uint64_t size() const {
+    return n_;
+  }
+
+  explicit operator bool() const {
+    return text_ != nullptr;
+  }
+
+  bool contains_null() const {
+    return n_ > 2 && memchr(text_ + 1, 0, n_ - 2) != nullptr;
+  }
+
+private:
+  uint8_t* mapping_ = nullptr;
+  uint64_t mapping_size_ = 0;
+  const uint8_t* text_ = nullptr;
+  uint64_t n_ = 0;
+
+  void unmap() {
+    if (mapping_ != nullptr)
+      munmap(mapping_, mapping_size_);
+    mapping_ = nullptr;
+    text_ = nullptr;
+    n_ = 0;
+  }
+
+  void report_failure(const int fd, const std::string& file_name) {
+    std::cerr << "xss::mapped_text --- Cannot map file " << file_name << ": "
+              << strerror(errno) << std::endl;
+    close(fd);
+    unmap();
+  }
+};
+
+} // namespace xss
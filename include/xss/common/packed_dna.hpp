@@ -0,0 +1,166 @@
+//  Copyright (c) 2019 Jonas Ellert
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+
+
+#pragma once
+
+#include "lce.hpp"
+#include "util.hpp"
+#include "virtual_sentinels.hpp"
+#include <vector>
+
+namespace xss {
+
+// Selects the overloads for 2-bit packed DNA texts. Base k of the text is
+// stored in bits [2(k mod 32), 2(k mod 32) + 2) of word k / 32, where
+// A = 0, C = 1, G = 2 and T = 3. Like for without_sentinels, the text has
+// no sentinels, and the results are the ones of $text$ (n + 2 entries).
+struct packed_dna_type {};
+constexpr static packed_dna_type packed_dna{};
+
+// Packs the characters A, C, G and T (other characters are packed as A).
+inline static std::vector<uint64_t> pack_dna(const uint8_t* const text,
+                                             const uint64_t n) {
+  std::vector<uint64_t> result((n + 31) >> 5, 0);
+  for (uint64_t k = 0; k < n; ++k) {
+    const uint64_t base = (text[k] == 'C' || text[k] == 'c')   ? 1
+                          : (text[k] == 'G' || text[k] == 'g') ? 2
+                          : (text[k] == 'T' || text[k] == 't') ? 3
+                                                               : 0;
+    result[k >> 5] |= base << ((k & 31) << 1);
+  }
+  return result;
+}
+
+namespace internal {
+
+  // View of text[offset..] for the packed text $raw$ of length n. The
+  // characters are 1 (A) to 4 (T), and both sentinels are 0.
+  struct packed_dna_text {
+    const uint64_t* words;
+    uint64_t offset;
+    uint64_t n;
+
+    xss_always_inline uint8_t operator[](const uint64_t i) const {
+      const uint64_t idx = offset + i - 1;
+      return (idx < n - 2)
+                 ? ((words[idx >> 5] >> ((idx & 31) << 1)) & 3ULL) + 1
+                 : 0;
+    }
+
+    xss_always_inline packed_dna_text operator+(const uint64_t i) const {
+      return {words, offset + i, n};
+    }
+
+    // the 32 bases raw[idx, idx + 32), requires idx + 32 <= n - 2
+    xss_always_inline uint64_t bases(const uint64_t idx) const {
+      const uint64_t word = idx >> 5;
+      const uint64_t shift = (idx & 31) << 1;
+      if (shift == 0)
+        return words[word];
+      return (words[word] >> shift) | (words[word + 1] << (64 - shift));
+    }
+  };
+
+  template <>
+  struct text_traits<packed_dna_text> {
+    using value_type = uint8_t;
+    constexpr static bool virtual_sentinels = true;
+  };
+
+  xss_always_inline static packed_dna_text
+  with_virtual_sentinels(packed_dna_type,
+                         const uint64_t* const words,
+                         uint64_t const n) {
+    return {words, 0, n + 2};
+  }
+
+  // Compares 32 bases at a time (one XOR of two 64-bit words).
+  template <typename index_type, typename value_type>
+  struct lce_type<index_type, value_type, packed_dna_text> {
+    packed_dna_text text;
+    uint64_t n = 0;
+
+    // Compares 32 bases at a time while both suffixes have at least 32 real
+    // (non-sentinel) characters within [lower, upper).
+    xss_always_inline uint64_t compare_blocks(const uint64_t l,
+                                              const uint64_t r,
+                                              uint64_t lower,
+                                              const uint64_t upper) const {
+      if (std::min(l, r) == 0)
+        return lower;
+      const uint64_t raw_end = text.n - 2;
+      uint64_t lhs = text.offset + l - 1 + lower;
+      uint64_t rhs = text.offset + r - 1 + lower;
+      while (lower + 32 <= upper && std::max(lhs, rhs) + 32 <= raw_end) {
+        const uint64_t diff = text.bases(lhs) ^ text.bases(rhs);
+        if (diff)
+          return lower + (__builtin_ctzll(diff) >> 1);
+        lower += 32;
+        lhs += 32;
+        rhs += 32;
+      }
+      return lower;
+    }
+
+    xss_always_inline index_type without_bounds(const index_type l,
+                                                const index_type r,
+                                                index_type lce = 0) const {
+      xss_statistics_add(lce_calls, 1);
+      [[maybe_unused]] const index_type lower = lce;
+      if (text[l + lce] != text[r + lce]) {
+        xss_statistics_add(lce_characters, 1);
+        return lce;
+      }
+      lce = compare_blocks(l, r, lce + 1, n);
+      while (text[l + lce] == text[r + lce])
+        ++lce;
+      xss_statistics_add(lce_characters, lce - lower + 1);
+      return lce;
+    }
+
+    xss_always_inline index_type
+    with_both_bounds(const index_type l,
+                     const index_type r,
+                     index_type lower,
+                     const index_type upper) const {
+      xss_statistics_add(lce_calls, 1);
+      [[maybe_unused]] const index_type initial_lower = lower;
+      lower = compare_blocks(l, r, lower, upper);
+      while (lower < upper && text[l + lower] == text[r + lower])
+        ++lower;
+      xss_statistics_add(lce_characters,
+                         lower - initial_lower + ((lower < upper) ? 1 : 0));
+      return lower;
+    }
+
+    xss_always_inline index_type with_upper_bound(
+        const index_type l, const index_type r, const index_type upper) const {
+      return with_both_bounds(l, r, 0, upper);
+    }
+
+    xss_always_inline index_type with_lower_bound(
+        const index_type l, const index_type r, const index_type lower) const {
+      return without_bounds(l, r, lower);
+    }
+  };
+
+} // namespace internal
+} // namespace xss
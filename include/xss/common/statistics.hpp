@@ -0,0 +1,147 @@
+//  Copyright (c) 2019 Jonas Ellert
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Counters are only maintained if XSS_STATISTICS is defined. Otherwise,
+// xss_statistics_add does not even evaluate its arguments.
+#ifdef XSS_STATISTICS
+#define xss_statistics_add(counter, value)                                     \
+  (::xss::internal::local_statistics().counter += (value))
+#else
+#define xss_statistics_add(counter, value) ((void) 0)
+#endif
+
+namespace xss {
+
+struct statistics {
+  // main loop iterations with lce <= threshold, and fallbacks to find_pss
+  uint64_t fast_path = 0;
+  uint64_t slow_path = 0;
+  uint64_t find_pss_calls = 0;
+  uint64_t find_pss_iterations = 0;
+  uint64_t run_extensions = 0;
+  uint64_t run_extension_entries = 0;
+  uint64_t lookaheads = 0;
+  uint64_t lookahead_entries = 0;
+  uint64_t lce_calls = 0;
+  uint64_t lce_characters = 0;
+  // entries moved from the buffer of the stack into the telescope stack
+  uint64_t stack_spills = 0;
+  uint64_t stack_refills = 0;
+
+  statistics& operator+=(const statistics& other) {
+    fast_path += other.fast_path;
+    slow_path += other.slow_path;
+    find_pss_calls += other.find_pss_calls;
+    find_pss_iterations += other.find_pss_iterations;
+    run_extensions += other.run_extensions;
+    run_extension_entries += other.run_extension_entries;
+    lookaheads += other.lookaheads;
+    lookahead_entries += other.lookahead_entries;
+    lce_calls += other.lce_calls;
+    lce_characters += other.lce_characters;
+    stack_spills += other.stack_spills;
+    stack_refills += other.stack_refills;
+    return *this;
+  }
+
+  std::string to_string() const {
+    std::stringstream result;
+    result << "fast_path=" << fast_path << " slow_path=" << slow_path
+           << " find_pss_calls=" << find_pss_calls
+           << " find_pss_iterations=" << find_pss_iterations
+           << " run_extensions=" << run_extensions
+           << " run_extension_entries=" << run_extension_entries
+           << " lookaheads=" << lookaheads
+           << " lookahead_entries=" << lookahead_entries
+           << " lce_calls=" << lce_calls
+           << " lce_characters=" << lce_characters
+           << " stack_spills=" << stack_spills
+           << " stack_refills=" << stack_refills;
+    return result.str();
+  }
+};
+
+namespace internal {
+
+  // Each thread counts into its own statistics, which are merged on request
+  // (and when the thread exits).
+  struct statistics_registry {
+    std::mutex mutex;
+    std::vector<statistics*> threads;
+    statistics finished;
+  };
+
+  inline statistics_registry& get_statistics_registry() {
+    static statistics_registry registry;
+    return registry;
+  }
+
+  struct thread_statistics : public statistics {
+    thread_statistics() {
+      auto& registry = get_statistics_registry();
+      std::lock_guard<std::mutex> lock(registry.mutex);
+      registry.threads.push_back(this);
+    }
+
+    ~thread_statistics() {
+      auto& registry = get_statistics_registry();
+      std::lock_guard<std::mutex> lock(registry.mutex);
+      registry.finished += *this;
+      registry.threads.erase(std::find(registry.threads.begin(),
+                                       registry.threads.end(), this));
+    }
+  };
+
+  inline statistics& local_statistics() {
+    thread_local thread_statistics local;
+    return local;
+  }
+
+} // namespace internal
+
+// Sum of the counters of all threads (only call while no construction is
+// running). All counters are zero unless XSS_STATISTICS is defined.
+inline static statistics get_statistics() {
+  auto& registry = internal::get_statistics_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  statistics result = registry.finished;
+  for (const auto thread : registry.threads)
+    result += *thread;
+  return result;
+}
+
+inline static void reset_statistics() {
+  auto& registry = internal::get_statistics_registry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.finished = statistics();
+  for (const auto thread : registry.threads)
+    *thread = statistics();
+}
+
+} // namespace xss
@@ -20,6 +20,7 @@
 
 #pragma once
 
+#include "statistics.hpp"
 #include <cstdint>
 #include <iostream>
 #include <limits>
@@ -27,6 +28,7 @@
 #include <vector>
 
 #define xss_always_inline __attribute__((always_inline)) inline
+#define xss_never_inline __attribute__((noinline))
 #define xss_likely(x) __builtin_expect(!!(x), 1)
 #define xss_unlikely(x) __builtin_expect(!!(x), 0)
 
@@ -41,6 +43,25 @@ namespace internal {
     threshold = std::max(threshold, MIN_THRESHOLD);
   }
 
+  // blocks smaller than this are not worth an extra thread
+  constexpr static uint64_t MIN_PARALLEL_BLOCK_SIZE = 1ULL << 16;
+
+  inline static uint64_t parallel_blocks(const uint64_t n,
+                                         const uint64_t threads) {
+    return std::max((uint64_t) 1,
+                    std::min(threads, n / MIN_PARALLEL_BLOCK_SIZE));
+  }
+
+  // LCEs of the block [begin, end) may reach one block length beyond the
+  // block. Longer LCEs mostly occur on periodic texts, where they would cost
+  // O(n) time per block (the last block is unbounded).
+  inline static uint64_t parallel_block_limit(const uint64_t begin,
+                                              const uint64_t end,
+                                              const uint64_t n) {
+    const uint64_t limit = end + (end - begin);
+    return (limit + 1 >= n) ? n : limit;
+  }
+
   template <typename index_type>
   static void warn_type_width(const uint64_t n, const std::string name) {
     if (n > std::numeric_limits<index_type>::max()) {
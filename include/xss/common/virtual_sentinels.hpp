@@ -0,0 +1,87 @@
+//  Copyright (c) 2019 Jonas Ellert
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+
+#pragma once
+
+#include "util.hpp"
+#include <type_traits>
+
+namespace xss {
+
+// Selects the overloads for texts without sentinels.
+struct without_sentinels_type {};
+constexpr static without_sentinels_type without_sentinels{};
+
+namespace internal {
+
+  __extension__ typedef unsigned __int128 uint128_t;
+
+  template <typename value_type>
+  struct widened_type {
+    static_assert(std::is_unsigned<value_type>::value);
+    using type = std::conditional_t<
+        sizeof(value_type) == 1, uint16_t,
+        std::conditional_t<sizeof(value_type) == 2, uint32_t,
+                           std::conditional_t<sizeof(value_type) == 4,
+                                              uint64_t, uint128_t>>>;
+  };
+
+  // View of text[offset..] for a text $raw$ of length n, where raw has length
+  // n - 2 and both $ are virtual characters smaller than all characters of
+  // raw. Characters are widened so that the sentinels fit into the alphabet.
+  template <typename value_type>
+  struct virtual_sentinel_text {
+    using char_type = typename widened_type<value_type>::type;
+
+    const value_type* raw;
+    uint64_t offset;
+    uint64_t n;
+
+    xss_always_inline char_type operator[](const uint64_t i) const {
+      const uint64_t idx = offset + i - 1;
+      return (idx < n - 2) ? (char_type) raw[idx] + 1 : 0;
+    }
+
+    xss_always_inline virtual_sentinel_text
+    operator+(const uint64_t i) const {
+      return {raw, offset + i, n};
+    }
+  };
+
+  template <typename text_type>
+  struct text_traits {
+    using value_type = std::remove_cv_t<std::remove_pointer_t<text_type>>;
+    constexpr static bool virtual_sentinels = false;
+  };
+
+  template <typename value_type_>
+  struct text_traits<virtual_sentinel_text<value_type_>> {
+    using value_type = value_type_;
+    constexpr static bool virtual_sentinels = true;
+  };
+
+  template <typename value_type>
+  xss_always_inline virtual_sentinel_text<value_type>
+  with_virtual_sentinels(value_type const* const text, uint64_t const n) {
+    return {text, 0, n + 2};
+  }
+
+} // namespace internal
+} // namespace xss
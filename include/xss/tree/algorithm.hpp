@@ -25,73 +25,212 @@
 #include "find_pss.hpp"
 #include "run_extension.hpp"
 #include "stack.hpp"
+#include "xss/common/context.hpp"
+#include "xss/common/packed_dna.hpp"
 #include "xss/common/util.hpp"
 
 namespace xss {
 
-template <typename index_type = uint64_t, typename value_type>
-static void pss_tree(value_type const* const text,
-                     uint64_t* const result_data,
-                     uint64_t const n,
-                     uint64_t threshold = internal::DEFAULT_THRESHOLD) {
-  using namespace internal;
-  using stack_type = buffered_stack<telescope_stack, index_type>;
-  warn_type_width<index_type>(n, "xss::pss_tree");
-  fix_threshold(threshold);
-
-  bit_vector result(result_data, (n << 1) + 2);
-  parentheses_stream stream(result);
-  stack_type stack(n >> 3, telescope_stack());
-  tree_context_type<stack_type, index_type, value_type> ctx{
-      text, result, stream, stack, (index_type) n};
-
-  // open node 0;
-  stream.append_opening_parenthesis();
-  stream.append_opening_parenthesis();
-
-  index_type j, lce;
-  for (index_type i = 1; i < n - 1; ++i) {
-    j = i - 1; // = stack.top();
-    lce = ctx.get_lce.without_bounds(j, i);
-
-    if (xss_likely(lce <= threshold)) {
-      while (text[j + lce] > text[i + lce]) {
-        stack.pop();
-        j = stack.top();
-        stream.append_closing_parenthesis();
-        lce = ctx.get_lce.without_bounds(j, i);
-        if (xss_unlikely(lce > threshold))
-          break;
+namespace internal {
+
+  // Processes the positions in [begin, end), where begin - 1 is the top of
+  // the stack. Stops early if an LCE of the context was cut off (see
+  // bounded_lce_type).
+  template <typename ctx_type, typename index_type>
+  static void pss_tree_scan(ctx_type& ctx,
+                            index_type const begin,
+                            index_type const end,
+                            uint64_t const threshold) {
+    const auto text = ctx.text;
+    auto& stack = ctx.stack;
+    auto& stream = ctx.stream;
+
+    index_type j, lce;
+    for (index_type i = begin; i < end; ++i) {
+      if (lce_truncated(ctx))
+        return;
+      j = i - 1; // = stack.top();
+      lce = ctx.get_lce.without_bounds(j, i);
+
+      if (xss_likely(lce <= threshold)) {
+        while (text[j + lce] > text[i + lce]) {
+          stack.pop();
+          j = stack.top();
+          stream.append_closing_parenthesis();
+          lce = ctx.get_lce.without_bounds(j, i);
+          if (xss_unlikely(lce > threshold))
+            break;
+        }
       }
-    }
 
-    if (xss_likely(lce <= threshold)) {
+      if (xss_likely(lce <= threshold)) {
+        stack.push(i);
+        stream.append_opening_parenthesis();
+        xss_statistics_add(fast_path, 1);
+        continue;
+      }
+
+      if (lce_truncated(ctx))
+        return;
+      xss_statistics_add(slow_path, 1);
+      index_type max_lce = 0, max_lce_j = 0, pss_of_i = 0;
+      pss_tree_find_pss(ctx, j, i, lce, max_lce_j, max_lce, pss_of_i);
+      if (lce_truncated(ctx))
+        return;
+
       stack.push(i);
       stream.append_opening_parenthesis();
-      continue;
+
+      const index_type distance = i - max_lce_j;
+      if (xss_unlikely(max_lce >= 2 * distance))
+        pss_tree_run_extension(ctx, max_lce_j, i, max_lce, distance);
+      else
+        pss_tree_amortized_lookahead(ctx, max_lce_j, i, max_lce, distance);
     }
+  }
+
+  template <typename stack_type>
+  static stack_type make_stack(uint64_t const max_value,
+                               arena* const scratch) {
+    if constexpr (std::is_constructible_v<stack_type, uint64_t, arena*>)
+      return stack_type(max_value, scratch);
+    else
+      return stack_type(max_value);
+  }
 
-    index_type max_lce = 0, max_lce_j = 0, pss_of_i = 0;
-    pss_tree_find_pss(ctx, j, i, lce, max_lce_j, max_lce, pss_of_i);
+  // Writes the PSS tree into the given stream. The buffer of the stack takes
+  // at most stack_buffer_bytes (default n / 8), the remaining elements are
+  // kept in the telescope stack. If an arena is given, the stacks take their
+  // memory from it (if the base stack supports this, like
+  // contiguous_telescope_stack).
+  template <typename index_type,
+            typename base_stack_type,
+            typename stream_type,
+            typename text_type>
+  static void write_pss_tree(text_type const text,
+                             stream_type& stream,
+                             uint64_t const n,
+                             uint64_t threshold,
+                             uint64_t stack_buffer_bytes = 0,
+                             arena* const scratch = nullptr) {
+    using stack_type = buffered_stack<base_stack_type, index_type>;
+    using value_type = typename text_traits<text_type>::value_type;
+    warn_type_width<index_type>(n, "xss::pss_tree");
+    fix_threshold(threshold);
+    if (stack_buffer_bytes == 0)
+      stack_buffer_bytes = n >> 3;
 
-    stack.push(i);
+    stack_type stack(stack_buffer_bytes,
+                     make_stack<base_stack_type>(n, scratch), scratch);
+    tree_context_type<stack_type, index_type, value_type, text_type,
+                      stream_type>
+        ctx{text, stream, stack, (index_type) n};
+    ctx.scratch = scratch;
+
+    // open node 0;
+    stream.append_opening_parenthesis();
     stream.append_opening_parenthesis();
 
-    const index_type distance = i - max_lce_j;
-    if (xss_unlikely(max_lce >= 2 * distance))
-      pss_tree_run_extension(ctx, max_lce_j, i, max_lce, distance);
-    else
-      pss_tree_amortized_lookahead(ctx, max_lce_j, i, max_lce, distance);
-  }
+    pss_tree_scan(ctx, (index_type) 1, (index_type)(n - 1), threshold);
 
-  while (stack.top() > 0) {
-    stack.pop();
+    while (stack.top() > 0) {
+      stack.pop();
+      stream.append_closing_parenthesis();
+    }
+    stream.append_closing_parenthesis();
+    stream.append_opening_parenthesis();
+    stream.append_closing_parenthesis();
     stream.append_closing_parenthesis();
   }
-  stream.append_closing_parenthesis();
-  stream.append_opening_parenthesis();
-  stream.append_closing_parenthesis();
-  stream.append_closing_parenthesis();
+
+  // The hook is notified whenever a prefix of the result is final (see
+  // no_word_hook).
+  template <typename index_type,
+            typename base_stack_type,
+            typename hook_type = no_word_hook,
+            typename text_type>
+  static void build_pss_tree(text_type const text,
+                             uint64_t* const result_data,
+                             uint64_t const n,
+                             uint64_t const threshold,
+                             hook_type const hook = hook_type(),
+                             uint64_t const stack_buffer_bytes = 0,
+                             arena* const scratch = nullptr) {
+    bit_vector result(result_data, (n << 1) + 2);
+    basic_parentheses_stream<hook_type> stream(result, hook);
+    write_pss_tree<index_type, base_stack_type>(text, stream, n, threshold,
+                                                stack_buffer_bytes, scratch);
+  }
+
+} // namespace internal
+
+// The stack_type contiguous_telescope_stack allocates its memory up front
+// (about n/32 words, plus n/8 bytes for the buffer of the stack) instead of
+// in small chunks.
+template <typename index_type = uint64_t,
+          typename stack_type = telescope_stack,
+          typename value_type>
+static void pss_tree(value_type const* const text,
+                     uint64_t* const result_data,
+                     uint64_t const n,
+                     uint64_t threshold = internal::DEFAULT_THRESHOLD) {
+  internal::build_pss_tree<index_type, stack_type>(text, result_data, n,
+                                                   threshold);
+}
+
+// Number of bytes of an arena for pss_tree(arena&, ...) on texts of length n:
+// the telescope stack, the buffer of the stack (n / 8 bytes), and 64KiB for
+// the reverse stacks of the slow path (each with its header). Only the first
+// two are bounded in n. The reverse stacks hold up to one LCE many nodes, so
+// on texts with long repetitions they may exceed their budget, in which case
+// the remaining memory is taken from the heap (see arena::overflow_bytes()).
+inline static uint64_t pss_tree_arena_bytes(uint64_t const n) {
+  return contiguous_telescope_stack_words::required_words(n) *
+             sizeof(uint64_t) +
+         std::max(n >> 3, (uint64_t) 64 * 1024) + 64 * 1024 +
+         3 * (arena::alignment + arena::header_bytes);
+}
+
+// Takes all scratch memory from the given arena, which is empty again
+// afterwards. Thus, an arena of pss_tree_arena_bytes(n) bytes can be reused
+// for any number of constructions, usually without allocating memory.
+template <typename index_type = uint64_t, typename value_type>
+static void pss_tree(arena& scratch,
+                     value_type const* const text,
+                     uint64_t* const result_data,
+                     uint64_t const n,
+                     uint64_t threshold = internal::DEFAULT_THRESHOLD) {
+  internal::build_pss_tree<index_type, contiguous_telescope_stack>(
+      text, result_data, n, threshold, internal::no_word_hook(), 0, &scratch);
+}
+
+// Takes a text of length n without sentinels. The result is the PSS tree of
+// $text$, where $ is smaller than all other characters (2n + 6 bits).
+template <typename index_type = uint64_t,
+          typename stack_type = telescope_stack,
+          typename value_type>
+static void pss_tree(without_sentinels_type,
+                     value_type const* const text,
+                     uint64_t* const result_data,
+                     uint64_t const n,
+                     uint64_t threshold = internal::DEFAULT_THRESHOLD) {
+  internal::build_pss_tree<index_type, stack_type>(
+      internal::with_virtual_sentinels(text, n), result_data, n + 2,
+      threshold);
+}
+
+// Takes a 2-bit packed DNA text of length n (see packed_dna_type). The result
+// is the PSS tree of $text$ (2n + 6 bits).
+template <typename index_type = uint64_t,
+          typename stack_type = telescope_stack>
+static void pss_tree(packed_dna_type,
+                     uint64_t const* const text,
+                     uint64_t* const result_data,
+                     uint64_t const n,
+                     uint64_t threshold = internal::DEFAULT_THRESHOLD) {
+  internal::build_pss_tree<index_type, stack_type>(
+      internal::with_virtual_sentinels(packed_dna, text, n), result_data,
+      n + 2, threshold);
 }
 
 } // namespace xss
@@ -20,6 +20,7 @@
 
 #pragma once
 
+#include "bit_vector.hpp"
 #include "xss/common/anchor.hpp"
 #include "xss/common/util.hpp"
 
@@ -36,30 +37,52 @@ namespace internal {
                                const index_type distance) {
 
     bool j_smaller_i = ctx.text[j + lce] < ctx.text[i + lce];
-    const index_type anchor = get_anchor(&(ctx.text[i]), lce);
     const uint64_t bps_distance = 2 * distance - ((j_smaller_i) ? (1) : (0));
-
-    if (bps_distance <= 64)
-      return;
+    xss_statistics_add(lookaheads, 1);
 
     auto& stack = ctx.stack;
-    auto& bv = ctx.bv;
     auto& stream = ctx.stream;
-    uint64_t bps_idx = stream.bits_written() - bps_distance;
-    uint64_t count_open = 0;
+    if (bps_distance <= 64 || !stream.can_copy(bps_distance))
+      return;
 
-    while (count_open < anchor - 1) {
-      if (bv.get(bps_idx++)) {
-        stream.append_opening_parenthesis();
-        count_open++;
-        stack.push(i + count_open);
-      } else {
-        stream.append_closing_parenthesis();
-        stack.pop();
+    const index_type anchor =
+        std::min(ctx_type::anchor_type::get(ctx, i, lce),
+                 (index_type)(ctx.end - i));
+
+    // The copied bits end with the (anchor - 1)-th opening parenthesis. Since
+    // anchor <= lce / 4 < distance / 2, they lie within the last bps_distance
+    // bits, so the copy does not overlap.
+    const uint64_t source = stream.bits_written() - bps_distance;
+    const uint64_t target = anchor - 1;
+    uint64_t length = 0;
+    uint64_t count_open = 0;
+    while (count_open < target && length < bps_distance) {
+      const uint64_t count = std::min((uint64_t) 64, bps_distance - length);
+      uint64_t word = stream.get_bits(source + length, count);
+      uint64_t used = count;
+      const uint64_t ones = __builtin_popcountll(word);
+      if (count_open + ones >= target) {
+        used = select_in_word(word, target - count_open) + 1;
+        word &= (used < 64) ? ((1ULL << used) - 1) : ~0ULL;
       }
+      // replay the parentheses on the stack
+      uint64_t position = 0;
+      while (word) {
+        const uint64_t next = __builtin_ctzll(word);
+        for (; position < next; ++position)
+          stack.pop();
+        stack.push(i + (++count_open));
+        ++position;
+        word &= word - 1;
+      }
+      for (; position < used; ++position)
+        stack.pop();
+      length += used;
     }
+    stream.append_copy(bps_distance, length);
 
-    i += anchor - 1;
+    i += count_open;
+    xss_statistics_add(lookahead_entries, count_open);
   }
 
 } // namespace internal
@@ -20,19 +20,25 @@
 
 #pragma once
 
+#include "xss/common/large_buffer.hpp"
 #include "xss/common/util.hpp"
 #include <cstring>
 #include <sstream>
 
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
 namespace xss {
 
 class bit_vector {
 private:
-  uint64_t n_bits_;
-  uint64_t n_words_;
-  uint64_t n_bytes_;
-  uint64_t* data_;
-  uint64_t* delete_data_;
+  uint64_t n_bits_ = 0;
+  uint64_t n_words_ = 0;
+  uint64_t n_bytes_ = 0;
+  large_buffer buffer_;
+  uint64_t* data_ = nullptr;
+  uint64_t* delete_data_ = nullptr;
 
   xss_always_inline static uint64_t mod64(const uint64_t idx) {
     return idx - ((idx >> 6) << 6);
@@ -53,6 +59,15 @@ public:
       memset(data_, 0, n_bytes_);
   }
 
+  // Takes the memory from a large_buffer (e.g. backed by huge pages). The bits
+  // are not initialized, unless options.populate is set (then they are zero).
+  bit_vector(const uint64_t n, const memory_options& options)
+      : n_bits_(n),
+        n_words_((n_bits_ + 127) >> 6),
+        n_bytes_(n_words_ << 3),
+        buffer_(n_bytes_, options),
+        data_(buffer_.data<uint64_t>()) {}
+
   bit_vector(uint64_t* data, uint64_t n)
       : n_bits_(n),
         n_words_((n_bits_ + 63) >> 6),
@@ -100,7 +115,9 @@ public:
     n_bits_ = other.n_bits_;
     n_words_ = other.n_words_;
     n_bytes_ = other.n_bytes_;
+    std::swap(buffer_, other.buffer_);
     std::swap(data_, other.data_);
+    std::swap(delete_data_, other.delete_data_);
     return (*this);
   }
 
@@ -111,10 +128,90 @@ public:
   bit_vector(const bit_vector& other) = delete;
 };
 
-class parentheses_stream {
+namespace internal {
+
+  // Reads length <= 64 bits starting at bit idx.
+  xss_always_inline static uint64_t read_bits(const uint64_t* data,
+                                              const uint64_t idx,
+                                              const uint64_t length) {
+    const uint64_t word = idx >> 6;
+    const uint64_t offset = idx & 63ULL;
+    uint64_t result = data[word] >> offset;
+    if (offset + length > 64)
+      result |= data[word + 1] << (64 - offset);
+    return (length < 64) ? (result & ((1ULL << length) - 1)) : result;
+  }
+
+  // Copies length bits from src_idx to dst_idx, where src_idx + length <=
+  // dst_idx (the ranges do not overlap).
+  inline static void copy_bits(uint64_t* const data,
+                               uint64_t dst_idx,
+                               uint64_t src_idx,
+                               uint64_t length) {
+    while (length > 0) {
+      const uint64_t offset = dst_idx & 63ULL;
+      const uint64_t bits = std::min(64 - offset, length);
+      const uint64_t value = read_bits(data, src_idx, bits);
+      if (bits == 64) {
+        data[dst_idx >> 6] = value;
+      } else {
+        const uint64_t mask = ((1ULL << bits) - 1) << offset;
+        data[dst_idx >> 6] = (data[dst_idx >> 6] & ~mask) | (value << offset);
+      }
+      dst_idx += bits;
+      src_idx += bits;
+      length -= bits;
+    }
+  }
+
+  // position of the r-th (1-based) set bit of word
+  xss_always_inline static uint64_t select_in_word(uint64_t word,
+                                                   const uint64_t r) {
+#if defined(__BMI2__)
+    return __builtin_ctzll(_pdep_u64(1ULL << (r - 1), word));
+#else
+    for (uint64_t k = 1; k < r; ++k)
+      word &= word - 1;
+    return __builtin_ctzll(word);
+#endif
+  }
+
+  // ORs length bits from src (starting at bit src_idx) into dst (starting at
+  // bit dst_idx). Words that are only partially covered may be shared with
+  // other threads and are updated atomically.
+  inline static void or_copy_bits(uint64_t* const dst,
+                                  uint64_t dst_idx,
+                                  const uint64_t* const src,
+                                  uint64_t src_idx,
+                                  uint64_t length) {
+    while (length > 0) {
+      const uint64_t offset = dst_idx & 63ULL;
+      const uint64_t bits = std::min(64 - offset, length);
+      const uint64_t value = read_bits(src, src_idx, bits) << offset;
+      if (bits == 64)
+        dst[dst_idx >> 6] = value;
+      else
+        __atomic_fetch_or(&(dst[dst_idx >> 6]), value, __ATOMIC_RELAXED);
+      dst_idx += bits;
+      src_idx += bits;
+      length -= bits;
+    }
+  }
+
+  // Called by the parentheses stream whenever 64 more words have been written
+  // (and after copies), with the number of words that are final.
+  struct no_word_hook {
+    xss_always_inline void operator()(const uint64_t) const {}
+  };
+
+} // namespace internal
+
+template <typename hook_type = internal::no_word_hook>
+class basic_parentheses_stream {
 private:
   bit_vector& bv_;
   uint64_t* bv_data_;
+  hook_type hook_;
 
   uint64_t current_word_macro_idx_;
   uint64_t current_word_micro_idx_;
@@ -125,13 +222,16 @@ private:
       bv_data_[current_word_macro_idx_++] = current_word_;
       current_word_micro_idx_ = 0;
       current_word_ = 0ULL;
+      if ((current_word_macro_idx_ & 63ULL) == 0)
+        hook_(current_word_macro_idx_);
     }
   }
 
 public:
-  parentheses_stream(bit_vector& bv)
+  basic_parentheses_stream(bit_vector& bv, hook_type hook = hook_type())
       : bv_(bv),
         bv_data_(bv_.data()),
+        hook_(hook),
         current_word_macro_idx_(0),
         current_word_micro_idx_(0),
         current_word_(0ULL) {}
@@ -148,6 +248,31 @@ public:
     current_word_ = bv_data_[current_word_macro_idx_];
   }
 
+  // all previous bits can be read and copied
+  xss_always_inline bool can_copy(const uint64_t) const {
+    return true;
+  }
+
+  // bit at position idx < bits_written()
+  xss_always_inline bool get(const uint64_t idx) const {
+    if ((idx >> 6) == current_word_macro_idx_)
+      return current_word_ & (1ULL << (idx & 63ULL));
+    return bv_.get(idx);
+  }
+
+  // bits [idx, idx + count) for count <= 64 and idx + count <= bits_written()
+  xss_always_inline uint64_t get_bits(const uint64_t idx,
+                                      const uint64_t count) const {
+    const auto word = [&](const uint64_t w) {
+      return (w == current_word_macro_idx_) ? current_word_ : bv_data_[w];
+    };
+    const uint64_t offset = idx & 63ULL;
+    uint64_t result = word(idx >> 6) >> offset;
+    if (offset + count > 64)
+      result |= word((idx >> 6) + 1) << (64 - offset);
+    return (count < 64) ? (result & ((1ULL << count) - 1)) : result;
+  }
+
   xss_always_inline void append_opening_parenthesis() {
     current_word_ |= (1ULL << current_word_micro_idx_);
     automatic_new_word();
@@ -164,21 +289,28 @@ public:
     const uint64_t rhs =
         (current_word_macro_idx_ << 6) + current_word_micro_idx_;
     const uint64_t lhs = rhs - distance;
-    for (uint64_t i = 0; i < length; ++i) {
-      bv_.set(rhs + i, bv_.get(lhs + i));
+    // If the ranges overlap, the result is periodic. Each step copies a
+    // multiple of the period, such that the copied part doubles.
+    for (uint64_t copied = 0; copied < length;) {
+      const uint64_t step = std::min(length - copied, distance + copied);
+      internal::copy_bits(bv_data_, rhs + copied, lhs, step);
+      copied += step;
     }
     current_word_micro_idx_ += length;
     current_word_macro_idx_ += current_word_micro_idx_ >> 6;
     current_word_micro_idx_ =
         current_word_micro_idx_ - ((current_word_micro_idx_ >> 6) << 6);
     fetch();
+    hook_(current_word_macro_idx_);
   }
 
-  ~parentheses_stream() {
+  ~basic_parentheses_stream() {
     flush();
   }
 };
 
+using parentheses_stream = basic_parentheses_stream<>;
+
 } // namespace xss
 
 namespace std {
@@ -21,6 +21,7 @@
 #pragma once
 
 #include "stack.hpp"
+#include "xss/common/context.hpp"
 #include "xss/common/util.hpp"
 
 namespace xss {
@@ -34,6 +35,7 @@ namespace internal {
                                                   index_type& max_lce_j,
                                                   index_type& max_lce,
                                                   index_type& pss_of_i) {
+    xss_statistics_add(find_pss_calls, 1);
 
     if (ctx.text[j + lce] < ctx.text[i + lce]) {
       max_lce = lce;
@@ -43,13 +45,14 @@ namespace internal {
 
     // reverse stack will contains elements that might be the PSS of i
     auto& stack = ctx.stack;
-    reverse_telescope_stack reverse_stack;
+    reverse_telescope_stack reverse_stack(ctx.scratch);
     uint64_t rev_stack_size = 0;
 
     index_type new_j = j;
     index_type new_lce = lce;
 
     while (ctx.text[new_j + new_lce] > ctx.text[i + new_lce]) {
+      xss_statistics_add(find_pss_iterations, 1);
       // new_j = stack.top() is not the pss.
       max_lce_j = new_j;
       max_lce = new_lce;
@@ -74,6 +77,8 @@ namespace internal {
 
       new_j = reverse_stack.top();
       new_lce = ctx.get_lce.without_bounds(new_j, i);
+      if (lce_truncated(ctx))
+        return;
     }
 
     //    std::cout << "RSS: " << rev_stack_size << " new_j: " << new_j <<
@@ -82,6 +87,7 @@ namespace internal {
     // now the PSS is contained in the reverse stack (or it is 0)
     // find it with binary search!
     while (rev_stack_size > 1) {
+      xss_statistics_add(find_pss_iterations, 1);
       const uint64_t half_size = (rev_stack_size >> 1);
       for (uint64_t k = 0; k < half_size; ++k) {
         stack.push(reverse_stack.top());
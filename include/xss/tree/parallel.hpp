@@ -0,0 +1,273 @@
+//  Copyright (c) 2019 Jonas Ellert
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+
+
+#pragma once
+
+#include "algorithm.hpp"
+#include "bit_vector.hpp"
+#include "stack.hpp"
+#include "xss/common/context.hpp"
+#include "xss/common/util.hpp"
+
+namespace xss {
+
+namespace internal {
+
+  // Each block [begin, end) is processed as if the text started with a
+  // sentinel at begin - 1 (we use the actual sentinel at index 0 instead).
+  // The resulting partial BPS only lacks the closing parentheses of nodes
+  // from preceding blocks, which have to be inserted right before the
+  // opening parentheses of the prefix minima of the block. The LCEs of a
+  // block are bounded by parallel_block_limit. If one of them is cut off,
+  // the block (and the rest of the text) is processed sequentially instead.
+  template <typename index_type>
+  struct tree_block_type {
+    uint64_t begin;
+    uint64_t end;
+
+    std::vector<uint64_t> bps;
+    uint64_t bps_size;
+
+    // (BPS index of opening parenthesis, text position) of prefix minima
+    std::vector<std::pair<uint64_t, index_type>> minima;
+    // stack after processing the block (bottom to top, without 0)
+    std::vector<index_type> remaining;
+    // (BPS index, number of closing parentheses inserted at this index)
+    std::vector<std::pair<uint64_t, uint64_t>> gaps;
+    // index of the first bit of the block in the final BPS
+    uint64_t offset;
+    // the scan stopped at an LCE beyond the limit of the block
+    bool truncated = false;
+  };
+
+  // The BPS of the sequential rest of the text does not contain the
+  // parentheses of the preceding blocks, so the run extensions and lookaheads
+  // may only copy periods that start within it.
+  class rest_parentheses_stream : public parentheses_stream {
+  public:
+    using parentheses_stream::parentheses_stream;
+
+    xss_always_inline bool can_copy(const uint64_t distance) const {
+      return distance <= bits_written();
+    }
+  };
+
+  template <typename index_type, typename value_type>
+  static void parallel_pss_tree_scan_block(value_type const* const text,
+                                           uint64_t const n,
+                                           tree_block_type<index_type>& block,
+                                           uint64_t const threshold) {
+    using stack_type = buffered_stack<telescope_stack, index_type>;
+    const uint64_t length = block.end - block.begin;
+    block.bps.resize(((length << 1) >> 6) + 2);
+    bit_vector bv(block.bps.data(), (length << 1) + 64);
+
+    {
+      parentheses_stream stream(bv);
+      stack_type stack(length >> 3, telescope_stack());
+      tree_context_type<stack_type, index_type, value_type, const value_type*,
+                        parentheses_stream, blockwise_anchor,
+                        bounded_lce_type<index_type, value_type>>
+          ctx{text,
+              stream,
+              stack,
+              (index_type) n,
+              bounded_lce_type<index_type, value_type>{
+                  {text, n}, parallel_block_limit(block.begin, block.end, n)},
+              (index_type) block.end};
+
+      stack.push(block.begin);
+      stream.append_opening_parenthesis();
+      pss_tree_scan(ctx, (index_type)(block.begin + 1), (index_type) block.end,
+                    threshold);
+
+      block.truncated = ctx.get_lce.truncated;
+      if (block.truncated)
+        return;
+      block.bps_size = stream.bits_written();
+      while (stack.top() > 0) {
+        block.remaining.push_back(stack.top());
+        stack.pop();
+      }
+      std::reverse(block.remaining.begin(), block.remaining.end());
+    }
+
+    uint64_t depth = 0;
+    index_type position = block.begin;
+    for (uint64_t k = 0; k < block.bps_size; ++k) {
+      if (bv.get(k)) {
+        if (depth == 0)
+          block.minima.emplace_back(k, position);
+        ++depth;
+        ++position;
+      } else {
+        --depth;
+      }
+    }
+  }
+
+  // Processes [block.begin, n - 1) sequentially, continuing the global stack.
+  // Besides the nodes of the rest of the text, the BPS contains the closing
+  // parentheses of (at most block.begin) nodes of preceding blocks.
+  template <typename index_type, typename value_type, typename stack_type>
+  static void parallel_pss_tree_scan_rest(value_type const* const text,
+                                          uint64_t const n,
+                                          tree_block_type<index_type>& block,
+                                          stack_type& stack,
+                                          uint64_t const threshold) {
+    block.end = n - 1;
+    const uint64_t bits = ((block.end - block.begin) << 1) + block.begin;
+    block.bps.assign((bits >> 6) + 2, 0ULL);
+    bit_vector bv(block.bps.data(), bits + 64);
+
+    rest_parentheses_stream stream(bv);
+    tree_context_type<stack_type, index_type, value_type, const value_type*,
+                      rest_parentheses_stream>
+        ctx{text, stream, stack, (index_type) n};
+    pss_tree_scan(ctx, (index_type) block.begin, (index_type) block.end,
+                  threshold);
+    block.bps_size = stream.bits_written();
+    block.gaps.clear();
+  }
+
+  template <typename index_type, typename value_type>
+  static void parallel_pss_tree(value_type const* const text,
+                                uint64_t* const result_data,
+                                uint64_t const n,
+                                uint64_t blocks,
+                                uint64_t const threads,
+                                uint64_t threshold) {
+    using stack_type = buffered_stack<telescope_stack, index_type>;
+    fix_threshold(threshold);
+
+    // positions [1, n - 1) are split into blocks of (almost) equal size
+    const uint64_t inner = n - 2;
+    blocks = std::max((uint64_t) 1, std::min(blocks, inner));
+    std::vector<tree_block_type<index_type>> block(blocks);
+    for (uint64_t b = 0; b < blocks; ++b) {
+      block[b].begin = 1 + (b * inner) / blocks;
+      block[b].end = 1 + ((b + 1) * inner) / blocks;
+    }
+
+#pragma omp parallel for num_threads(threads) schedule(dynamic, 1)
+    for (uint64_t b = 0; b < blocks; ++b) {
+      parallel_pss_tree_scan_block(text, n, block[b], threshold);
+    }
+
+    // resolve the parentheses that cross block borders (the global stack
+    // only contains the nodes that remain after each block)
+    stack_type stack(n >> 3, telescope_stack());
+    uint64_t offset = 2;
+    for (uint64_t b = 0; b < blocks; ++b) {
+      block[b].offset = offset;
+      if (block[b].truncated) {
+        parallel_pss_tree_scan_rest(text, n, block[b], stack, threshold);
+        blocks = b + 1;
+        break;
+      }
+
+      // the merge uses the limit of the block, but completes LCEs that are
+      // cut off (and then hands the next block to the sequential scan)
+      const bounded_lce_type<index_type, value_type> bounded_lce{
+          {text, n}, parallel_block_limit(block[b].begin, block[b].end, n)};
+      const auto get_lce = [&](const index_type l, const index_type r) {
+        const index_type lce = bounded_lce.without_bounds(l, r);
+        if (xss_unlikely(bounded_lce.truncated))
+          return bounded_lce.unbounded.without_bounds(l, r, lce);
+        return lce;
+      };
+      for (const auto& minimum : block[b].minima) {
+        const index_type i = minimum.second;
+        uint64_t closing = 0;
+        index_type j = stack.top();
+        index_type lce = get_lce(j, i);
+        while (text[j + lce] > text[i + lce]) {
+          stack.pop();
+          ++closing;
+          j = stack.top();
+          lce = get_lce(j, i);
+        }
+        if (closing > 0)
+          block[b].gaps.emplace_back(minimum.first, closing);
+        offset += closing;
+      }
+      offset += block[b].bps_size;
+      for (const auto node : block[b].remaining)
+        stack.push(node);
+      std::vector<std::pair<uint64_t, index_type>>().swap(block[b].minima);
+      std::vector<index_type>().swap(block[b].remaining);
+      if (bounded_lce.truncated && b + 1 < blocks)
+        block[b + 1].truncated = true;
+    }
+
+    // the BPS is zero-initialized, such that only the partial BPS have to be
+    // copied (the missing closing parentheses are zeros)
+    const uint64_t words = ((n << 1) + 2 + 63) >> 6;
+#pragma omp parallel num_threads(threads)
+    {
+#pragma omp for schedule(static)
+      for (uint64_t w = 0; w < words; ++w)
+        result_data[w] = 0ULL;
+
+#pragma omp for schedule(dynamic, 1)
+      for (uint64_t b = 0; b < blocks; ++b) {
+        const auto& current = block[b];
+        uint64_t src_idx = 0;
+        uint64_t dst_idx = current.offset;
+        for (const auto& gap : current.gaps) {
+          or_copy_bits(result_data, dst_idx, current.bps.data(), src_idx,
+                       gap.first - src_idx);
+          dst_idx += gap.first - src_idx + gap.second;
+          src_idx = gap.first;
+        }
+        or_copy_bits(result_data, dst_idx, current.bps.data(), src_idx,
+                     current.bps_size - src_idx);
+      }
+    }
+
+    // open the artificial root and node 0, and open node n - 1
+    bit_vector result(result_data, (n << 1) + 2);
+    result.set_one(0);
+    result.set_one(1);
+    result.set_one((n << 1) - 1);
+  }
+
+} // namespace internal
+
+namespace parallel {
+
+  template <typename index_type = uint64_t, typename value_type>
+  static void pss_tree(value_type const* const text,
+                       uint64_t* const result_data,
+                       uint64_t const n,
+                       uint64_t const threads,
+                       uint64_t threshold = internal::DEFAULT_THRESHOLD) {
+    using namespace internal;
+    warn_type_width<index_type>(n, "xss::parallel::pss_tree");
+    const uint64_t blocks = parallel_blocks(n, threads);
+    if (blocks < 2)
+      return xss::pss_tree<index_type>(text, result_data, n, threshold);
+    parallel_pss_tree<index_type>(text, result_data, n, blocks, threads,
+                                  threshold);
+  }
+
+} // namespace parallel
+} // namespace xss
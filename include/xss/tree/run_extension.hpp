@@ -34,13 +34,19 @@ namespace internal {
                          const index_type period) {
     bool j_smaller_i = ctx.text[j + lce] < ctx.text[i + lce];
     const uint64_t bps_distance = 2 * period - ((j_smaller_i) ? (1) : (0));
-    const index_type repetitions = lce / period - 1;
+    // otherwise, the run is processed by the main loop
+    if (!ctx.stream.can_copy(bps_distance))
+      return;
+    const index_type repetitions =
+        std::min(lce / period - 1, (ctx.end - 1 - i) / period);
 
     //    std::cout << "RE " << j << " " << i << " " << lce << " " <<
     //    j_smaller_i
     //              << " " << repetitions << " " << bps_distance << std::flush;
 
     i += (repetitions * period);
+    xss_statistics_add(run_extensions, 1);
+    xss_statistics_add(run_extension_entries, repetitions * period);
     if (j_smaller_i) {
       for (uint64_t r = 0; r < repetitions; ++r) {
         ctx.stack.push(ctx.stack.top() + period);
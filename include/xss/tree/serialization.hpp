@@ -0,0 +1,281 @@
+//  Copyright (c) 2019 Jonas Ellert
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+
+
+#pragma once
+
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+#include "bit_vector.hpp"
+#include "support/pss_tree_support.hpp"
+#include "xss/common/util.hpp"
+
+// File format of a PSS tree (all sections start at multiples of 64 bytes):
+//   [0, 64)              header (see pss_tree_file_header)
+//   [64, 64 + 8w)        the w words of the BPS (padded to 64 bytes)
+//   [support_offset, ..) the serialized pss_tree_support (optional)
+// All values are stored in the byte order of the machine.
+
+namespace xss {
+
+namespace internal {
+
+  constexpr static char PSS_TREE_FILE_MAGIC[8] = {'X', 'S', 'S', 'T',
+                                                  'R', 'E', 'E', '\0'};
+  // version 2: the checksum also covers the support
+  // version 3: the select samples of the support have 64 bits
+  // version 4: the blocks of the support grow with the BPS, and the select
+  //            samples are 16-bit offsets from absolute samples
+  constexpr static uint32_t PSS_TREE_FILE_VERSION = 4;
+
+  struct alignas(64) pss_tree_file_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t has_support;
+    // length of the text (including sentinels), the BPS has 2n + 2 bits
+    uint64_t n;
+    // threshold that was used for the construction (informational)
+    uint64_t threshold;
+    uint64_t bps_words;
+    uint64_t support_offset;
+    uint64_t support_bytes;
+    // checksum of the BPS words and the support (see bps_checksum)
+    uint64_t checksum;
+  };
+  static_assert(sizeof(pss_tree_file_header) == 64);
+
+  // Fast, non-cryptographic checksum of a sequence of words. A checksum can be
+  // continued with further words by passing it as seed.
+  inline static uint64_t bps_checksum(const uint64_t* words,
+                                      const uint64_t count,
+                                      const uint64_t seed = 0) {
+    uint64_t result = count ^ seed;
+    for (uint64_t i = 0; i < count; ++i) {
+      result = (result ^ words[i]) * 0x9E3779B97F4A7C15ULL;
+      result ^= result >> 29;
+    }
+    return result;
+  }
+
+  xss_always_inline static uint64_t padded_to_64(const uint64_t bytes) {
+    return (bytes + 63) & ~63ULL;
+  }
+
+} // namespace internal
+
+// Writes the PSS tree (the BPS of a text of length n) into a file. If a
+// support is given, it is stored as well, such that it does not have to be
+// rebuilt after loading. Returns false if the file cannot be written.
+inline static bool
+save_pss_tree(const std::string& file_name,
+              const uint64_t* bps,
+              const uint64_t n,
+              const uint64_t threshold = internal::DEFAULT_THRESHOLD,
+              const pss_tree_support* support = nullptr) {
+  using namespace internal;
+  const uint64_t bps_words = ((n << 1) + 2 + 63) >> 6;
+  const uint64_t bps_bytes = padded_to_64(bps_words << 3);
+
+  pss_tree_file_header header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, PSS_TREE_FILE_MAGIC, sizeof(header.magic));
+  header.version = PSS_TREE_FILE_VERSION;
+  header.has_support = (support != nullptr);
+  header.n = n;
+  header.threshold = threshold;
+  header.bps_words = bps_words;
+  header.support_offset = (support != nullptr) ? (64 + bps_bytes) : 0;
+  header.support_bytes = (support != nullptr) ? support->serialized_bytes() : 0;
+  header.checksum = bps_checksum(bps, bps_words);
+
+  // the serialized support is a multiple of 64 bytes
+  std::vector<uint64_t> serialized(header.support_bytes >> 3);
+  if (support != nullptr) {
+    support->serialize((uint8_t*) serialized.data());
+    header.checksum =
+        bps_checksum(serialized.data(), serialized.size(), header.checksum);
+  }
+
+  std::ofstream out(file_name, std::ios::binary | std::ios::trunc);
+  out.write((const char*) &header, sizeof(header));
+  out.write((const char*) bps, bps_words << 3);
+  const char padding[64] = {};
+  out.write(padding, bps_bytes - (bps_words << 3));
+  out.write((const char*) serialized.data(), header.support_bytes);
+  out.close();
+  if (!out) {
+    std::cerr << "xss::save_pss_tree --- Cannot write file " << file_name
+              << "." << std::endl;
+    return false;
+  }
+  return true;
+}
+
+inline static bool
+save_pss_tree(const std::string& file_name,
+              const bit_vector& bv,
+              const uint64_t threshold = internal::DEFAULT_THRESHOLD,
+              const pss_tree_support* support = nullptr) {
+  return save_pss_tree(file_name, bv.data(), (bv.size() - 2) >> 1, threshold,
+                       support);
+}
+
+// Read-only PSS tree that is mapped from a file written by save_pss_tree.
+// The BPS is not copied: bps() is a non-owning bit_vector on the mapping,
+// which must not be written. The checksum is only verified on request,
+// since this reads the whole BPS.
+class mapped_pss_tree {
+public:
+  mapped_pss_tree() = default;
+
+  mapped_pss_tree(const std::string& file_name, const bool verify = false) {
+    using namespace internal;
+    const int fd = open(file_name.c_str(), O_RDONLY);
+    if (fd < 0) {
+      std::cerr << "xss::mapped_pss_tree --- Cannot open file " << file_name
+                << "." << std::endl;
+      return;
+    }
+    struct stat st;
+    const bool has_size = (fstat(fd, &st) == 0);
+    const uint64_t size = has_size ? st.st_size : 0;
+    if (size >= sizeof(pss_tree_file_header)) {
+      void* base = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+      if (base != MAP_FAILED) {
+        mapping_ = (uint8_t*) base;
+        mapping_size_ = size;
+      }
+    }
+    close(fd);
+
+    if (mapping_ == nullptr || !valid(verify)) {
+      std::cerr << "xss::mapped_pss_tree --- File " << file_name
+                << " does not contain a valid PSS tree." << std::endl;
+      unmap();
+      return;
+    }
+    bps_ = bit_vector((uint64_t*) (mapping_ + 64), (header().n << 1) + 2);
+  }
+
+  mapped_pss_tree(const mapped_pss_tree&) = delete;
+  mapped_pss_tree& operator=(const mapped_pss_tree&) = delete;
+
+  mapped_pss_tree(mapped_pss_tree&& other) {
+    *this = std::move(other);
+  }
+
+  mapped_pss_tree& operator=(mapped_pss_tree&& other) {
+    std::swap(mapping_, other.mapping_);
+    std::swap(mapping_size_, other.mapping_size_);
+    bps_ = std::move(other.bps_);
+    return *this;
+  }
+
+  ~mapped_pss_tree() {
+    unmap();
+  }
+
+  explicit operator bool() const {
+    return mapping_ != nullptr;
+  }
+
+  const bit_vector& bps() const {
+    return bps_;
+  }
+
+  uint64_t n() const {
+    return header().n;
+  }
+
+  uint64_t threshold() const {
+    return header().threshold;
+  }
+
+  bool has_support() const {
+    return header().has_support;
+  }
+
+  // The stored support (if any), otherwise a newly built one. Like the BPS,
+  // the stored support is used in place, so it is only valid as long as this
+  // tree is mapped.
+  pss_tree_support support() const {
+    if (has_support()) {
+      return pss_tree_support(bps_.data(), bps_.size(),
+                              mapping_ + header().support_offset,
+                              header().support_bytes,
+                              pss_tree_support::view_type());
+    }
+    return pss_tree_support(bps_.data(), bps_.size());
+  }
+
+private:
+  uint8_t* mapping_ = nullptr;
+  uint64_t mapping_size_ = 0;
+  bit_vector bps_ = bit_vector(nullptr, 0);
+
+  const internal::pss_tree_file_header& header() const {
+    return *((const internal::pss_tree_file_header*) mapping_);
+  }
+
+  bool valid(const bool verify) const {
+    using namespace internal;
+    const auto& h = header();
+    if (memcmp(h.magic, PSS_TREE_FILE_MAGIC, sizeof(h.magic)) != 0 ||
+        h.version != PSS_TREE_FILE_VERSION || h.n > (mapping_size_ << 2) ||
+        h.bps_words != (((h.n << 1) + 2 + 63) >> 6) ||
+        64 + (h.bps_words << 3) > mapping_size_)
+      return false;
+    if (h.has_support &&
+        (h.support_offset < 64 + (h.bps_words << 3) ||
+         h.support_offset % 64 != 0 || h.support_bytes % 64 != 0 ||
+         h.support_bytes > mapping_size_ ||
+         h.support_offset > mapping_size_ - h.support_bytes ||
+         !pss_tree_support::deserializable((h.n << 1) + 2,
+                                           mapping_ + h.support_offset,
+                                           h.support_bytes)))
+      return false;
+    if (!verify)
+      return true;
+    uint64_t checksum =
+        bps_checksum((const uint64_t*) (mapping_ + 64), h.bps_words);
+    if (h.has_support)
+      checksum = bps_checksum((const uint64_t*) (mapping_ + h.support_offset),
+                              h.support_bytes >> 3, checksum);
+    return checksum == h.checksum;
+  }
+
+  void unmap() {
+    if (mapping_ != nullptr)
+      munmap(mapping_, mapping_size_);
+    mapping_ = nullptr;
+    mapping_size_ = 0;
+  }
+};
+
+} // namespace xss
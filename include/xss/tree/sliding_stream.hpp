@@ -0,0 +1,235 @@
+//  Copyright (c) 2019 Jonas Ellert
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+
+
+#pragma once
+
+#include <algorithm>
+#include <type_traits>
+#include <unistd.h>
+#include <vector>
+
+#include "algorithm.hpp"
+#include "xss/common/util.hpp"
+
+namespace xss {
+
+// Passes the words of a BPS to a file descriptor (e.g. an open file or a
+// pipe). After the construction, ok() tells whether all writes succeeded.
+class fd_word_sink {
+private:
+  int fd_;
+  bool ok_ = true;
+
+public:
+  fd_word_sink(const int fd) : fd_(fd) {}
+
+  void operator()(const uint64_t* words, const uint64_t count) {
+    const char* ptr = (const char*) words;
+    uint64_t bytes = count << 3;
+    while (ok_ && bytes > 0) {
+      const ssize_t w = write(fd_, ptr, bytes);
+      ok_ = (w > 0);
+      ptr += (w > 0) ? w : 0;
+      bytes -= (w > 0) ? w : 0;
+    }
+  }
+
+  bool ok() const {
+    return ok_;
+  }
+};
+
+// Parentheses stream that only keeps a sliding window of the most recent
+// words. Older words are passed to the sink, which is called with
+// (const uint64_t* words, uint64_t count) for consecutive ranges of words.
+// Copies that reach back further than the window are not possible; the
+// construction then falls back to the main loop, which only affects the
+// running time. The window holds between half and all of its words.
+template <typename sink_type>
+class sliding_parentheses_stream {
+private:
+  std::vector<uint64_t> window_;
+  const uint64_t mask_;
+  const uint64_t half_;
+  sink_type& sink_;
+
+  uint64_t current_word_macro_idx_ = 0;
+  uint64_t current_word_micro_idx_ = 0;
+  uint64_t current_word_ = 0ULL;
+  // the words before flushed_ have been passed to the sink
+  uint64_t flushed_ = 0;
+  bool finished_ = false;
+
+  xss_always_inline static uint64_t window_words(const uint64_t bytes) {
+    uint64_t words = 128;
+    while ((words << 4) <= bytes)
+      words <<= 1;
+    return words;
+  }
+
+  xss_always_inline void store_word() {
+    window_[current_word_macro_idx_++ & mask_] = current_word_;
+    current_word_micro_idx_ = 0;
+    current_word_ = 0ULL;
+    // the next word overwrites the oldest half of the window
+    if (xss_unlikely((current_word_macro_idx_ & (half_ - 1)) == 0 &&
+                     current_word_macro_idx_ > half_)) {
+      sink_(&(window_[flushed_ & mask_]), half_);
+      flushed_ += half_;
+    }
+  }
+
+  xss_always_inline void automatic_new_word() {
+    if (xss_unlikely(++current_word_micro_idx_ == 64))
+      store_word();
+  }
+
+public:
+  sliding_parentheses_stream(sink_type& sink, const uint64_t window_bytes)
+      : window_(window_words(window_bytes)),
+        mask_(window_.size() - 1),
+        half_(window_.size() >> 1),
+        sink_(sink) {}
+
+  xss_always_inline uint64_t bits_written() const {
+    return (current_word_macro_idx_ << 6) + current_word_micro_idx_;
+  }
+
+  xss_always_inline bool can_copy(const uint64_t distance) const {
+    return distance < ((half_ - 1) << 6);
+  }
+
+  // bit at position idx < bits_written() (within the window)
+  xss_always_inline bool get(const uint64_t idx) const {
+    const uint64_t word = idx >> 6;
+    const uint64_t value = (word == current_word_macro_idx_)
+                               ? current_word_
+                               : window_[word & mask_];
+    return value & (1ULL << (idx & 63ULL));
+  }
+
+  // bits [idx, idx + count) for count <= 64 and idx + count <= bits_written()
+  // (within the window)
+  xss_always_inline uint64_t get_bits(const uint64_t idx,
+                                      const uint64_t count) const {
+    const auto word = [&](const uint64_t w) {
+      return (w == current_word_macro_idx_) ? current_word_
+                                            : window_[w & mask_];
+    };
+    const uint64_t offset = idx & 63ULL;
+    uint64_t result = word(idx >> 6) >> offset;
+    if (offset + count > 64)
+      result |= word((idx >> 6) + 1) << (64 - offset);
+    return (count < 64) ? (result & ((1ULL << count) - 1)) : result;
+  }
+
+  xss_always_inline void append_opening_parenthesis() {
+    current_word_ |= (1ULL << current_word_micro_idx_);
+    automatic_new_word();
+  }
+
+  xss_always_inline void append_closing_parenthesis() {
+    current_word_ &= ~(1ULL << current_word_micro_idx_);
+    automatic_new_word();
+  }
+
+  // appends the count <= 64 bits of value (higher bits must be zero)
+  xss_always_inline void append_bits(const uint64_t value,
+                                     const uint64_t count) {
+    const uint64_t free = 64 - current_word_micro_idx_;
+    current_word_ |= value << current_word_micro_idx_;
+    if (count < free) {
+      current_word_micro_idx_ += count;
+    } else {
+      store_word();
+      if (count > free) {
+        current_word_ = value >> free;
+        current_word_micro_idx_ = count - free;
+      }
+    }
+  }
+
+  // copies up to 64 bits at a time (at most distance, if the ranges overlap)
+  void append_copy(const uint64_t distance, const uint64_t length) {
+    uint64_t source = bits_written() - distance;
+    for (uint64_t copied = 0; copied < length;) {
+      const uint64_t count =
+          std::min({(uint64_t) 64, distance, length - copied});
+      append_bits(get_bits(source, count), count);
+      source += count;
+      copied += count;
+    }
+  }
+
+  // passes the remaining words (the last one padded with zeros) to the sink
+  void finish() {
+    if (finished_)
+      return;
+    finished_ = true;
+    if (current_word_micro_idx_ > 0)
+      store_word();
+    while (flushed_ < current_word_macro_idx_) {
+      const uint64_t begin = flushed_ & mask_;
+      const uint64_t count = std::min(current_word_macro_idx_ - flushed_,
+                                      window_.size() - begin);
+      sink_(&(window_[begin]), count);
+      flushed_ += count;
+    }
+  }
+
+  ~sliding_parentheses_stream() {
+    finish();
+  }
+};
+
+// Computes the PSS tree (like pss_tree), but passes its words to the sink
+// instead of writing them into memory (see sliding_parentheses_stream). In
+// total, ceil((2n + 2) / 64) words are passed. Apart from the text, the
+// construction only needs the window and the stack.
+template <typename index_type = uint64_t,
+          typename value_type,
+          typename sink_type>
+static void pss_tree_to_sink(value_type const* const text,
+                             uint64_t const n,
+                             sink_type&& sink,
+                             uint64_t const window_bytes = 1ULL << 20,
+                             uint64_t threshold = internal::DEFAULT_THRESHOLD) {
+  sliding_parentheses_stream<std::remove_reference_t<sink_type>> stream(
+      sink, window_bytes);
+  internal::write_pss_tree<index_type, telescope_stack>(text, stream, n,
+                                                        threshold);
+  stream.finish();
+}
+
+// Writes the PSS tree into the file descriptor. Returns false if a write
+// failed.
+template <typename index_type = uint64_t, typename value_type>
+static bool pss_tree_to_file(value_type const* const text,
+                             uint64_t const n,
+                             const int fd,
+                             uint64_t const window_bytes = 1ULL << 20,
+                             uint64_t threshold = internal::DEFAULT_THRESHOLD) {
+  fd_word_sink sink(fd);
+  pss_tree_to_sink<index_type>(text, n, sink, window_bytes, threshold);
+  return sink.ok();
+}
+
+} // namespace xss
@@ -20,14 +20,175 @@
 
 #pragma once
 
+#include "xss/common/arena.hpp"
 #include "xss/common/util.hpp"
+#include <algorithm>
 #include <cmath>
 #include <stack>
+#include <type_traits>
 
-class telescope_stack {
+// The words of the telescope stack are kept in two stacks: the left stack
+// contains the bit vector, the right stack contains the (value, bit) pairs
+// of large offsets.
+class telescope_stack_words {
 private:
-  std::stack<uint64_t> data_left_;
-  std::stack<uint64_t> data_right_;
+  std::stack<uint64_t> left_;
+  std::stack<uint64_t> right_;
+
+public:
+  telescope_stack_words(const uint64_t = 0) {}
+
+  xss_always_inline void push_left(const uint64_t word) {
+    left_.push(word);
+  }
+
+  xss_always_inline uint64_t top_left() const {
+    return left_.top();
+  }
+
+  xss_always_inline void pop_left() {
+    left_.pop();
+  }
+
+  xss_always_inline uint64_t size_left() const {
+    return left_.size();
+  }
+
+  xss_always_inline void push_right(const uint64_t word) {
+    right_.push(word);
+  }
+
+  xss_always_inline uint64_t top_right() const {
+    return right_.top();
+  }
+
+  xss_always_inline void pop_right() {
+    right_.pop();
+  }
+};
+
+// Both stacks in a single array: the left stack grows upwards from the
+// front, the right stack grows downwards from the back. If the words are
+// supplied by the caller, they are never reallocated (use required_words).
+// Otherwise, the array grows geometrically. All memory is taken from the
+// arena if one is given (and from the heap otherwise).
+class contiguous_telescope_stack_words {
+private:
+  uint64_t* words_ = nullptr;
+  uint64_t capacity_ = 0;
+  uint64_t left_ = 0;
+  uint64_t right_ = 0;
+  bool owned_ = true;
+  xss::arena* scratch_ = nullptr;
+
+  void grow() {
+    const uint64_t new_capacity = std::max(capacity_ << 1, (uint64_t) 64);
+    const uint64_t right_size = capacity_ - right_;
+    const uint64_t bytes = capacity_ * sizeof(uint64_t);
+    const uint64_t new_bytes = new_capacity * sizeof(uint64_t);
+    uint64_t* new_words = words_;
+    if (!(owned_ && scratch_ && scratch_->extend(words_, bytes, new_bytes))) {
+      new_words =
+          (uint64_t*) xss::internal::allocate_scratch(scratch_, new_bytes);
+      std::copy(words_, words_ + left_, new_words);
+    }
+    std::copy_backward(words_ + right_, words_ + capacity_,
+                       new_words + new_capacity);
+    if (owned_ && new_words != words_)
+      xss::internal::free_scratch(scratch_, words_, bytes);
+    words_ = new_words;
+    capacity_ = new_capacity;
+    right_ = new_capacity - right_size;
+    owned_ = true;
+  }
+
+public:
+  // number of words that suffice for values up to max_value
+  xss_always_inline static uint64_t required_words(const uint64_t max_value) {
+    // the bit vector has max_value + 1 bits, and there is at most one
+    // (value, bit) pair per 128 bits (plus the initial word)
+    return (max_value >> 6) + (max_value >> 6) + 4;
+  }
+
+  contiguous_telescope_stack_words() {}
+
+  contiguous_telescope_stack_words(const uint64_t max_value,
+                                   xss::arena* const scratch = nullptr)
+      : words_((uint64_t*) xss::internal::allocate_scratch(
+            scratch, required_words(max_value) * sizeof(uint64_t))),
+        capacity_(required_words(max_value)), right_(capacity_),
+        scratch_(scratch) {}
+
+  // if the words do not suffice, the stack continues in the arena (or heap)
+  contiguous_telescope_stack_words(uint64_t* const words,
+                                   const uint64_t capacity,
+                                   xss::arena* const scratch = nullptr)
+      : words_(words), capacity_(capacity), right_(capacity), owned_(false),
+        scratch_(scratch) {}
+
+  xss_always_inline void push_left(const uint64_t word) {
+    if (xss_unlikely(left_ == right_))
+      grow();
+    words_[left_++] = word;
+  }
+
+  xss_always_inline uint64_t top_left() const {
+    return words_[left_ - 1];
+  }
+
+  xss_always_inline void pop_left() {
+    --left_;
+  }
+
+  xss_always_inline uint64_t size_left() const {
+    return left_;
+  }
+
+  xss_always_inline void push_right(const uint64_t word) {
+    if (xss_unlikely(left_ == right_))
+      grow();
+    words_[--right_] = word;
+  }
+
+  xss_always_inline uint64_t top_right() const {
+    return words_[right_];
+  }
+
+  xss_always_inline void pop_right() {
+    ++right_;
+  }
+
+  contiguous_telescope_stack_words&
+  operator=(contiguous_telescope_stack_words&& other) {
+    std::swap(words_, other.words_);
+    std::swap(capacity_, other.capacity_);
+    std::swap(left_, other.left_);
+    std::swap(right_, other.right_);
+    std::swap(owned_, other.owned_);
+    std::swap(scratch_, other.scratch_);
+    return (*this);
+  }
+
+  contiguous_telescope_stack_words(contiguous_telescope_stack_words&& other) {
+    (*this) = std::move(other);
+  }
+
+  contiguous_telescope_stack_words(const contiguous_telescope_stack_words&) =
+      delete;
+  contiguous_telescope_stack_words&
+  operator=(const contiguous_telescope_stack_words&) = delete;
+
+  ~contiguous_telescope_stack_words() {
+    if (owned_)
+      xss::internal::free_scratch(scratch_, words_,
+                                  capacity_ * sizeof(uint64_t));
+  }
+};
+
+template <typename words_type>
+class basic_telescope_stack {
+private:
+  words_type data_;
 
   uint64_t top_bit_;
   uint64_t top_bit_mod64_;
@@ -36,25 +197,37 @@ private:
   uint64_t top_word_;
 
 public:
-  telescope_stack()
-      : top_bit_(0), top_bit_mod64_(0), top_value_(0), top_word_(1ULL) {
+  basic_telescope_stack(words_type&& words)
+      : data_(std::move(words)), top_bit_(0), top_bit_mod64_(0),
+        top_value_(0), top_word_(1ULL) {
     // fill last word with 1s
-    data_right_.push(std::numeric_limits<uint64_t>::max());
+    data_.push_right(std::numeric_limits<uint64_t>::max());
   }
 
-  telescope_stack(const uint64_t) : telescope_stack() {}
+  basic_telescope_stack() : basic_telescope_stack(words_type()) {}
+
+  // max_value is an upper bound for the pushed values
+  basic_telescope_stack(const uint64_t max_value)
+      : basic_telescope_stack(words_type(max_value)) {}
+
+  // only if the words support arenas (contiguous_telescope_stack)
+  template <typename words = words_type,
+            typename = std::enable_if_t<
+                std::is_constructible_v<words, uint64_t, xss::arena*>>>
+  basic_telescope_stack(const uint64_t max_value, xss::arena* const scratch)
+      : basic_telescope_stack(words_type(max_value, scratch)) {}
 
   xss_always_inline void push(const uint64_t value) {
     uint64_t offset = value - top_value_;
     if (xss_unlikely(offset > 127)) {
-      data_right_.push(top_value_);
-      data_right_.push(top_bit_);
+      data_.push_right(top_value_);
+      data_.push_right(top_bit_);
     } else {
       top_bit_ += offset;
       top_bit_mod64_ += offset;
       while (top_bit_mod64_ > 63) {
         top_bit_mod64_ -= 64;
-        data_left_.push(top_word_);
+        data_.push_left(top_word_);
         top_word_ = 0ULL;
       }
       top_word_ |= (1ULL << top_bit_mod64_);
@@ -67,48 +240,65 @@ public:
   }
 
   xss_always_inline void pop() {
-    if (xss_unlikely(top_bit_ == data_right_.top())) {
-      data_right_.pop();
-      top_value_ = data_right_.top();
-      data_right_.pop();
+    if (xss_unlikely(top_bit_ == data_.top_right())) {
+      data_.pop_right();
+      top_value_ = data_.top_right();
+      data_.pop_right();
     } else {
       const uint64_t previous_top_bit_ = top_bit_;
       top_word_ &= ~(1ULL << top_bit_mod64_);
       while (top_word_ == 0ULL) {
-        top_word_ = data_left_.top();
-        data_left_.pop();
+        top_word_ = data_.top_left();
+        data_.pop_left();
       }
       top_bit_mod64_ = 63 - __builtin_clzl(top_word_);
-      top_bit_ = ((data_left_.size()) << 6) + top_bit_mod64_;
+      top_bit_ = ((data_.size_left()) << 6) + top_bit_mod64_;
       top_value_ -= previous_top_bit_ - top_bit_;
     }
   }
 
-  telescope_stack& operator=(telescope_stack&& other) {
+  basic_telescope_stack& operator=(basic_telescope_stack&& other) {
     top_bit_ = other.top_bit_;
     top_bit_mod64_ = other.top_bit_mod64_;
     top_value_ = other.top_value_;
     top_word_ = other.top_word_;
-    std::swap(data_left_, other.data_left_);
-    std::swap(data_right_, other.data_right_);
+    std::swap(data_, other.data_);
     return (*this);
   }
 
-  telescope_stack(telescope_stack&& other) {
+  basic_telescope_stack(basic_telescope_stack&& other) {
     (*this) = std::move(other);
   }
 
-  telescope_stack(const telescope_stack&) = delete;
-  telescope_stack& operator=(const telescope_stack&) = delete;
+  basic_telescope_stack(const basic_telescope_stack&) = delete;
+  basic_telescope_stack& operator=(const basic_telescope_stack&) = delete;
 };
 
+using telescope_stack = basic_telescope_stack<telescope_stack_words>;
+
+// Without reallocations if constructed with an upper bound for the values.
+using contiguous_telescope_stack =
+    basic_telescope_stack<contiguous_telescope_stack_words>;
+
+// The words are taken from a small array inside the object first, such that
+// short-lived reverse stacks (as in pss_tree_find_pss) do not allocate any
+// memory. Larger ones continue in the arena (or heap).
 class reverse_telescope_stack {
 private:
-  telescope_stack base_stack;
+  constexpr static uint64_t local_words = 64;
+  uint64_t words_[local_words];
+  contiguous_telescope_stack base_stack;
 
 public:
   constexpr static uint64_t max_val = std::numeric_limits<uint64_t>::max();
 
+  reverse_telescope_stack(xss::arena* const scratch = nullptr)
+      : base_stack(contiguous_telescope_stack_words(words_, local_words,
+                                                    scratch)) {}
+
+  reverse_telescope_stack(const reverse_telescope_stack&) = delete;
+  reverse_telescope_stack& operator=(const reverse_telescope_stack&) = delete;
+
   xss_always_inline uint64_t top() const {
     return max_val - base_stack.top();
   }
@@ -126,6 +316,7 @@ public:
 template <typename stack_type, typename index_type>
 class buffered_stack {
 private:
+  xss::arena* const scratch_;
   const uint64_t buffer_capacity_;
   const uint64_t buffer_half_capacity_;
 
@@ -142,16 +333,34 @@ private:
     return (1ULL << log_bytes) / sizeof(index_type);
   }
 
+  xss_always_inline index_type* allocate_buffer(const uint64_t capacity) {
+    return (index_type*) xss::internal::allocate_scratch(
+        scratch_, capacity * sizeof(index_type));
+  }
+
+  xss_always_inline void free_buffer() {
+    xss::internal::free_scratch(scratch_, cur_buffer_,
+                                cur_buffer_capacity_ * sizeof(index_type));
+  }
+
+  // the base stack allocates all of its memory up front
+  constexpr static bool contiguous =
+      std::is_same_v<stack_type, contiguous_telescope_stack>;
+
 public:
-  buffered_stack(const uint64_t buffer_bytes, stack_type&& stack)
-      : buffer_capacity_(get_buffer_capacity(buffer_bytes)),
+  // With an arena or a contiguous_telescope_stack, the buffer has its final
+  // size right away (instead of growing from 64KiB).
+  buffered_stack(const uint64_t buffer_bytes,
+                 stack_type&& stack,
+                 xss::arena* const scratch = nullptr)
+      : scratch_(scratch), buffer_capacity_(get_buffer_capacity(buffer_bytes)),
         buffer_half_capacity_(buffer_capacity_ >> 1),
-        cur_buffer_capacity_(64ULL * 1024 / sizeof(index_type)),
-        cur_buffer_size_(1),
-        base_stack_(std::move(stack)) {
+        cur_buffer_capacity_((scratch || contiguous)
+                                 ? buffer_capacity_
+                                 : 64ULL * 1024 / sizeof(index_type)),
+        cur_buffer_size_(1), base_stack_(std::move(stack)) {
     static_assert(sizeof(index_type) == 4 || sizeof(index_type) == 8);
-    cur_buffer_ =
-        (index_type*) malloc(cur_buffer_capacity_ * sizeof(index_type));
+    cur_buffer_ = allocate_buffer(cur_buffer_capacity_);
     cur_buffer_[0] = 0ULL;
   }
 
@@ -166,9 +375,9 @@ public:
         for (uint64_t i = 0; i < cur_buffer_capacity_; ++i) {
           base_stack_.push(cur_buffer_[i] + 1);
         }
-        delete cur_buffer_;
-        cur_buffer_ =
-            (index_type*) malloc(buffer_capacity_ * sizeof(index_type));
+        xss_statistics_add(stack_spills, cur_buffer_capacity_);
+        free_buffer();
+        cur_buffer_ = allocate_buffer(buffer_capacity_);
         cur_buffer_capacity_ = buffer_capacity_;
         cur_buffer_size_ = 1;
         cur_buffer_[0] = e;
@@ -177,16 +386,16 @@ public:
           base_stack_.push(cur_buffer_[i] + 1);
           cur_buffer_[i] = cur_buffer_[i + buffer_half_capacity_];
         }
+        xss_statistics_add(stack_spills, buffer_half_capacity_);
         cur_buffer_size_ = buffer_half_capacity_ + 1;
         cur_buffer_[buffer_half_capacity_] = e;
       } else {
-        index_type* new_buffer = (index_type*) malloc(
-            (cur_buffer_capacity_ << 1) * sizeof(index_type));
+        index_type* new_buffer = allocate_buffer(cur_buffer_capacity_ << 1);
         for (uint64_t i = 0; i < cur_buffer_capacity_; ++i) {
           new_buffer[i] = cur_buffer_[i];
         }
         new_buffer[cur_buffer_capacity_] = e;
-        delete cur_buffer_;
+        free_buffer();
         cur_buffer_ = new_buffer;
         cur_buffer_capacity_ <<= 1;
         ++cur_buffer_size_;
@@ -201,6 +410,7 @@ public:
     --cur_buffer_size_;
     if (xss_unlikely(cur_buffer_size_ == 0)) {
       cur_buffer_size_ = cur_buffer_capacity_ >> 1;
+      xss_statistics_add(stack_refills, cur_buffer_size_);
       for (uint64_t i = cur_buffer_size_; i > 0;) {
         cur_buffer_[--i] = base_stack_.top() - 1;
         base_stack_.pop();
@@ -210,7 +420,7 @@ public:
   }
 
   ~buffered_stack() {
-    delete cur_buffer_;
+    free_buffer();
   }
 
   buffered_stack& operator=(buffered_stack&& other) = delete;
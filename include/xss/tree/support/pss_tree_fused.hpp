@@ -0,0 +1,64 @@
+//  Copyright (c) 2019 Jonas Ellert
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+
+
+#pragma once
+
+#include "pss_tree_support.hpp"
+#include "xss/tree/algorithm.hpp"
+
+namespace xss {
+
+namespace internal {
+
+  // Builds the support for all blocks of the BPS that are final. This is
+  // kept out of line, such that it does not bloat the construction loop.
+  struct pss_tree_support_hook {
+    pss_tree_support* support;
+
+    xss_never_inline void operator()(const uint64_t final_words) const {
+      support->build_until(final_words << 6);
+    }
+  };
+
+} // namespace internal
+
+// Computes the PSS tree (like pss_tree) and its support in a single pass:
+// every 4096 bits, the support of the new part of the BPS is built while it
+// is still in the cache. The result must provide room for 2n + 2 bits
+// (rounded up to 64 bits) plus one word.
+template <typename index_type = uint64_t,
+          typename stack_type = telescope_stack,
+          typename value_type>
+static pss_tree_support
+pss_tree_with_support(value_type const* const text,
+                      uint64_t* const result_data,
+                      uint64_t const n,
+                      uint64_t threshold = internal::DEFAULT_THRESHOLD) {
+  pss_tree_support support(result_data, (n << 1) + 2,
+                           pss_tree_support::incremental_type());
+  internal::build_pss_tree<index_type, stack_type>(
+      text, result_data, n, threshold,
+      internal::pss_tree_support_hook{&support});
+  support.finish();
+  return support;
+}
+
+} // namespace xss
@@ -0,0 +1,881 @@
+//  Copyright (c) 2019 Jonas Ellert
+//
+//  Permission is hereby granted, free of charge, to any person obtaining a copy
+//  of this software and associated documentation files (the "Software"), to
+//  deal in the Software without restriction, including without limitation the
+//  rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+//  sell copies of the Software, and to permit persons to whom the Software is
+//  furnished to do so, subject to the following conditions:
+//
+//  The above copyright notice and this permission notice shall be included in
+//  all copies or substantial portions of the Software.
+//
+//  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+//  FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+//  IN THE SOFTWARE.
+
+
+#pragma once
+
+#include "xss/common/util.hpp"
+#include "xss/tree/bit_vector.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+namespace xss {
+namespace internal {
+
+  // excess (opening minus closing parentheses) and minimum prefix excess of
+  // each byte (least significant bit first)
+  struct bps_byte_tables {
+    int8_t excess[256];
+    int8_t min_excess[256];
+
+    constexpr bps_byte_tables() : excess(), min_excess() {
+      for (int32_t byte = 0; byte < 256; ++byte) {
+        int32_t current = 0;
+        int32_t minimum = 8;
+        for (int32_t k = 0; k < 8; ++k) {
+          current += ((byte >> k) & 1) ? 1 : -1;
+          minimum = std::min(minimum, current);
+        }
+        excess[byte] = current;
+        min_excess[byte] = minimum;
+      }
+    }
+  };
+
+  constexpr static bps_byte_tables bps_bytes{};
+
+  // Array of the support that either owns its elements, or views elements
+  // that belong to someone else (e.g. a mapped file). Only owned arrays can
+  // be modified.
+  template <typename value_type>
+  class support_vector {
+  private:
+    std::vector<value_type> owned_;
+    const value_type* data_ = nullptr;
+    uint64_t size_ = 0;
+    bool is_view_ = false;
+
+    void own() {
+      data_ = owned_.data();
+      size_ = owned_.size();
+    }
+
+  public:
+    support_vector() = default;
+
+    support_vector(const value_type* data, const uint64_t size)
+        : data_(data), size_(size), is_view_(true) {}
+
+    support_vector(const support_vector& other)
+        : owned_(other.owned_), data_(other.data_), size_(other.size_),
+          is_view_(other.is_view_) {
+      if (!is_view_)
+        own();
+    }
+
+    support_vector(support_vector&& other) = default;
+
+    support_vector& operator=(support_vector other) {
+      std::swap(owned_, other.owned_);
+      std::swap(data_, other.data_);
+      std::swap(size_, other.size_);
+      std::swap(is_view_, other.is_view_);
+      return *this;
+    }
+
+    bool is_view() const {
+      return is_view_;
+    }
+
+    void resize(const uint64_t size, const value_type& value = value_type()) {
+      owned_.resize(size, value);
+      own();
+    }
+
+    // copies size elements from memory that may be unaligned
+    void assign(const uint8_t* bytes, const uint64_t size) {
+      owned_.resize(size);
+      memcpy((void*) owned_.data(), bytes, size * sizeof(value_type));
+      own();
+    }
+
+    void push_back(const value_type& value) {
+      owned_.push_back(value);
+      own();
+    }
+
+    xss_always_inline value_type& operator[](const uint64_t idx) {
+      return owned_[idx];
+    }
+
+    xss_always_inline const value_type& operator[](const uint64_t idx) const {
+      return data_[idx];
+    }
+
+    const value_type* data() const {
+      return data_;
+    }
+
+    uint64_t size() const {
+      return size_;
+    }
+  };
+
+} // namespace internal
+
+// Rank/select directory and range min-max tree for a BPS of m bits, which is
+// divided into blocks of b bits, where b is the smallest power of two that is
+// at least 512 and (log m)^2. Every eight blocks (a superblock) share one
+// cache-line-sized directory entry, which holds the ranks and minimum excess
+// values of the blocks. A binary tree over the minimum excess values of the
+// superblocks guides long searches. Every b-th opening parenthesis is sampled
+// for select, where a sample is a 16-bit offset from an absolute sample (one
+// per 64 samples). The directory and the tree take up to 96/b extra bits per
+// bit of the BPS, and the samples take 17/b bits per opening parenthesis.
+// Thus, the support takes o(m) bits: about 20% of the BPS for m < 2^22, 10%
+// for m < 2^32, and 5% beyond. In exchange, rank and select scan up to b bits.
+class pss_tree_support {
+private:
+  constexpr static uint64_t min_log_block_bits = 9;
+  constexpr static uint64_t max_log_block_bits = 13;
+  constexpr static uint64_t log_select_group = 6;
+  constexpr static uint64_t no_select_offset =
+      std::numeric_limits<uint16_t>::max();
+  constexpr static int64_t no_minimum = std::numeric_limits<int64_t>::max();
+
+  // smallest power of two (as exponent) that is at least (log bits)^2, such
+  // that the relative ranks and minima of a superblock fit into 16 bits
+  static uint64_t log_block_bits_for(const uint64_t bits) {
+    const uint64_t log_bits = 64 - __builtin_clzll(bits | 1ULL);
+    uint64_t result = min_log_block_bits;
+    while (result < max_log_block_bits &&
+           (1ULL << result) < log_bits * log_bits)
+      ++result;
+    return result;
+  }
+
+  struct alignas(64) directory_entry {
+    // number of opening parentheses before the superblock
+    uint64_t rank = 0;
+    // number of opening parentheses before each block (within superblock)
+    uint16_t block_rank[8] = {};
+    // minimum excess within each block (relative to the excess before it)
+    int16_t block_min[8] = {};
+  };
+
+  const uint64_t* data_;
+  const uint8_t* bytes_;
+  uint64_t bits_;
+  uint64_t log_block_bits_;
+  uint64_t block_bits_;
+  uint64_t log_super_bits_;
+  uint64_t super_bits_;
+
+  internal::support_vector<directory_entry> directory_;
+  // complete binary tree, leaves are the minimum excess of each superblock
+  internal::support_vector<int64_t> min_tree_;
+  uint64_t leaves_;
+  // The k-th select sample is the block that contains the (k * b + 1)-th
+  // opening parenthesis. It is the absolute sample of its group (every 64
+  // samples) plus its relative offset. An offset that does not fit is stored
+  // as no_select_offset, which is still a lower bound of the sample.
+  internal::support_vector<uint64_t> select_absolute_;
+  internal::support_vector<uint16_t> select_relative_;
+  uint64_t select_samples_ = 0;
+
+  xss_always_inline bool get(const uint64_t idx) const {
+    return data_[idx >> 6] & (1ULL << (idx & 63ULL));
+  }
+
+  xss_always_inline uint64_t ones_before_block(const uint64_t block) const {
+    const auto& entry = directory_[block >> 3];
+    return entry.rank + entry.block_rank[block & 7ULL];
+  }
+
+  xss_always_inline int64_t block_min(const uint64_t block) const {
+    return directory_[block >> 3].block_min[block & 7ULL];
+  }
+
+  xss_always_inline uint64_t select_lower_bound(const uint64_t k) const {
+    return select_absolute_[k >> log_select_group] + select_relative_[k];
+  }
+
+  xss_always_inline uint64_t select_upper_bound(const uint64_t k) const {
+    const uint64_t group = k >> log_select_group;
+    if (xss_likely(select_relative_[k] < no_select_offset))
+      return select_absolute_[group] + select_relative_[k];
+    return (group + 1 < select_absolute_.size()) ? select_absolute_[group + 1]
+                                                 : built_blocks_;
+  }
+
+  void push_select_sample(const uint64_t block) {
+    if ((select_samples_ & ((1ULL << log_select_group) - 1)) == 0)
+      select_absolute_.push_back(block);
+    select_relative_.push_back((uint16_t) std::min(
+        block - select_absolute_[select_absolute_.size() - 1],
+        no_select_offset));
+    ++select_samples_;
+  }
+
+  // excess of [0, idx)
+  xss_always_inline int64_t excess_before(const uint64_t idx) const {
+    return 2 * (int64_t) rank(idx) - (int64_t) idx;
+  }
+
+  // smallest superblock s' >= s with minimum excess <= target
+  uint64_t next_superblock(const uint64_t s, const int64_t target) const {
+    uint64_t v = leaves_ + s;
+    if (min_tree_[v] <= target)
+      return s;
+    while (v > 1) {
+      if (!(v & 1ULL) && min_tree_[v + 1] <= target) {
+        v = v + 1;
+        while (v < leaves_) {
+          v <<= 1;
+          if (min_tree_[v] > target)
+            ++v;
+        }
+        return v - leaves_;
+      }
+      v >>= 1;
+    }
+    return leaves_;
+  }
+
+  // largest superblock s' < s with minimum excess <= target
+  uint64_t previous_superblock(const uint64_t s, const int64_t target) const {
+    uint64_t v = leaves_ + s;
+    while (v > 1) {
+      if ((v & 1ULL) && min_tree_[v - 1] <= target) {
+        v = v - 1;
+        while (v < leaves_) {
+          v = (v << 1) + 1;
+          if (min_tree_[v] > target)
+            --v;
+        }
+        return v - leaves_;
+      }
+      v >>= 1;
+    }
+    return leaves_;
+  }
+
+  // Scans the bytes in [idx, end) for the first position whose excess is at
+  // most target. Returns false if there is no such position, in which case
+  // idx = end and excess is the excess before end.
+  xss_always_inline bool forward_bytes(uint64_t& idx,
+                                       const uint64_t end,
+                                       int64_t& excess,
+                                       const int64_t target) const {
+    using internal::bps_bytes;
+    for (; idx < end; idx += 8) {
+      const uint8_t byte = bytes_[idx >> 3];
+      if (excess + bps_bytes.min_excess[byte] <= target) {
+        for (uint64_t k = 0;; ++k) {
+          excess += ((byte >> k) & 1) ? 1 : -1;
+          if (excess <= target) {
+            idx += k;
+            return true;
+          }
+        }
+      }
+      excess += bps_bytes.excess[byte];
+    }
+    return false;
+  }
+
+  // Scans the bytes in [begin, idx) from right to left for the last position
+  // whose excess is at most target, where excess is the excess of [0, idx).
+  // On success, idx - 1 is the position. Otherwise, idx = begin.
+  xss_always_inline bool backward_bytes(uint64_t& idx,
+                                        const uint64_t begin,
+                                        int64_t& excess,
+                                        const int64_t target) const {
+    using internal::bps_bytes;
+    for (; idx > begin; idx -= 8) {
+      const uint8_t byte = bytes_[(idx >> 3) - 1];
+      const int64_t excess_before_byte = excess - bps_bytes.excess[byte];
+      if (excess_before_byte + bps_bytes.min_excess[byte] <= target) {
+        for (uint64_t k = 7;; --k) {
+          if (excess <= target) {
+            idx -= 7 - k;
+            return true;
+          }
+          excess -= ((byte >> k) & 1) ? 1 : -1;
+        }
+      }
+      excess = excess_before_byte;
+    }
+    return false;
+  }
+
+  // r-th (1-based) opening parenthesis after position idx
+  xss_always_inline uint64_t select_after(const uint64_t idx,
+                                          uint64_t r) const {
+    uint64_t w = (idx + 1) >> 6;
+    uint64_t word = data_[w] & (~0ULL << ((idx + 1) & 63ULL));
+    while (true) {
+      const uint64_t count = __builtin_popcountll(word);
+      if (r <= count)
+        return (w << 6) + internal::select_in_word(word, r);
+      r -= count;
+      word = data_[++w];
+    }
+  }
+
+  xss_always_inline void prefetch_select(const uint64_t k) const {
+    const uint64_t sample = (k - 1) >> log_block_bits_;
+    __builtin_prefetch(&(select_absolute_[sample >> log_select_group]));
+    __builtin_prefetch(&(select_relative_[sample]));
+  }
+
+  xss_always_inline void prefetch_node(const uint64_t bps_idx) const {
+    __builtin_prefetch(&(directory_[bps_idx >> log_super_bits_]));
+    __builtin_prefetch(&(data_[bps_idx >> 6]));
+  }
+
+  // Answers k queries, where query(preorder_number, bps_idx) answers one
+  // query for a node whose opening parenthesis is at bps_idx. Unsorted
+  // queries are processed in groups. While a group is answered, the nodes
+  // of the next group are selected, and the select samples of the group
+  // after that are prefetched.
+  template <typename query_type>
+  xss_always_inline void batch(const uint64_t* preorder_numbers,
+                               uint64_t* out,
+                               const uint64_t k,
+                               query_type&& query) const {
+    if (std::is_sorted(preorder_numbers, preorder_numbers + k)) {
+      // nearby nodes are found by scanning forward from the previous one
+      uint64_t previous_k = 0, previous_idx = 0;
+      for (uint64_t q = 0; q < k; ++q) {
+        const uint64_t current_k = preorder_numbers[q] + 2;
+        if (previous_k > 0 && current_k - previous_k <= 128) {
+          previous_idx = (current_k == previous_k)
+                             ? previous_idx
+                             : select_after(previous_idx,
+                                            current_k - previous_k);
+        } else {
+          previous_idx = select(current_k);
+        }
+        previous_k = current_k;
+        out[q] = query(preorder_numbers[q], previous_idx);
+      }
+      return;
+    }
+
+    constexpr uint64_t group = 16;
+    uint64_t bps_idx[2][group];
+    const auto group_size = [&](const uint64_t g) {
+      return std::min(group, k - g);
+    };
+    const auto select_group = [&](const uint64_t g) {
+      uint64_t* const current = bps_idx[(g / group) & 1ULL];
+      for (uint64_t q = 0; q < group_size(g); ++q) {
+        current[q] = select(preorder_numbers[g + q] + 2);
+        prefetch_node(current[q]);
+      }
+    };
+    const auto prefetch_group = [&](const uint64_t g) {
+      for (uint64_t q = 0; q < group_size(g); ++q)
+        prefetch_select(preorder_numbers[g + q] + 2);
+    };
+
+    if (k > group)
+      prefetch_group(group);
+    if (k > 0)
+      select_group(0);
+    for (uint64_t g = 0; g < k; g += group) {
+      if (g + 2 * group < k)
+        prefetch_group(g + 2 * group);
+      if (g + group < k)
+        select_group(g + group);
+      const uint64_t* const current = bps_idx[(g / group) & 1ULL];
+      for (uint64_t q = 0; q < group_size(g); ++q)
+        out[g + q] = query(preorder_numbers[g + q], current[q]);
+    }
+  }
+
+  void allocate() {
+    const uint64_t superblocks =
+        (bits_ + super_bits_ - 1) >> log_super_bits_;
+    directory_.resize(superblocks + 1);
+    leaves_ = 1;
+    while (leaves_ < superblocks + 1)
+      leaves_ <<= 1;
+    min_tree_.resize(leaves_ << 1, no_minimum);
+  }
+
+  static uint64_t padded(const uint64_t bytes) {
+    return (bytes + 63) & ~63ULL;
+  }
+
+  static uint64_t select_groups(const uint64_t samples) {
+    return (samples + (1ULL << log_select_group) - 1) >> log_select_group;
+  }
+
+  void restore(const uint8_t* serialized,
+               const uint64_t serialized_bytes,
+               const bool view) {
+    if (!deserializable(bits_, serialized, serialized_bytes)) {
+      allocate();
+      finish();
+      return;
+    }
+    uint64_t header[8];
+    memcpy(header, serialized, sizeof(header));
+    leaves_ = header[0];
+    built_blocks_ = header[4];
+    built_ones_ = header[5];
+    built_excess_ = (int64_t) header[6];
+    select_samples_ = header[3];
+    const uint64_t groups = select_groups(select_samples_);
+    serialized += 64;
+
+    const uint8_t* const directory = serialized;
+    serialized += header[1] * sizeof(directory_entry);
+    const uint8_t* const min_tree = serialized;
+    serialized += padded(header[2] * sizeof(int64_t));
+    const uint8_t* const select_absolute = serialized;
+    serialized += padded(groups * sizeof(uint64_t));
+    const uint8_t* const select_relative = serialized;
+    if (view) {
+      directory_ = {(const directory_entry*) directory, header[1]};
+      min_tree_ = {(const int64_t*) min_tree, header[2]};
+      select_absolute_ = {(const uint64_t*) select_absolute, groups};
+      select_relative_ = {(const uint16_t*) select_relative, select_samples_};
+    } else {
+      directory_.assign(directory, header[1]);
+      min_tree_.assign(min_tree, header[2]);
+      select_absolute_.assign(select_absolute, groups);
+      select_relative_.assign(select_relative, select_samples_);
+    }
+  }
+
+  // state of the construction (blocks are added from left to right)
+  uint64_t built_blocks_ = 0;
+  uint64_t built_ones_ = 0;
+  int64_t built_excess_ = 0;
+
+  void build_block(const uint64_t b) {
+    using internal::bps_bytes;
+    auto& entry = directory_[b >> 3];
+    if ((b & 7ULL) == 0)
+      entry.rank = built_ones_;
+    entry.block_rank[b & 7ULL] = built_ones_ - entry.rank;
+
+    uint64_t ones = built_ones_;
+    int64_t excess = built_excess_;
+    int64_t minimum = no_minimum;
+    const uint64_t end = std::min((b + 1) << log_block_bits_, bits_);
+    for (uint64_t idx = b << log_block_bits_; idx < end; idx += 8) {
+      const uint8_t byte = bytes_[idx >> 3];
+      if (idx + 8 <= end) {
+        minimum = std::min(minimum, excess + bps_bytes.min_excess[byte]);
+        excess += bps_bytes.excess[byte];
+        ones += __builtin_popcount(byte);
+      } else {
+        for (uint64_t k = 0; idx + k < end; ++k) {
+          const bool bit = (byte >> k) & 1;
+          excess += bit ? 1 : -1;
+          ones += bit;
+          minimum = std::min(minimum, excess);
+        }
+      }
+    }
+    entry.block_min[b & 7ULL] = minimum - built_excess_;
+
+    int64_t& leaf = min_tree_[leaves_ + (b >> 3)];
+    leaf = std::min(leaf, minimum);
+
+    // blocks that contain a sampled opening parenthesis
+    for (uint64_t k = (built_ones_ + block_bits_ - 1) >> log_block_bits_;
+         (k << log_block_bits_) < ones; ++k) {
+      push_select_sample(b);
+    }
+    built_ones_ = ones;
+    built_excess_ = excess;
+  }
+
+public:
+  struct incremental_type {};
+  struct view_type {};
+
+  // Incremental construction, e.g. while the BPS is being written: the
+  // support is ready after build_until(bits) or finish().
+  pss_tree_support(const uint64_t* data,
+                   const uint64_t bits,
+                   incremental_type)
+      : data_(data),
+        bytes_(reinterpret_cast<const uint8_t*>(data)),
+        bits_(bits),
+        log_block_bits_(log_block_bits_for(bits)),
+        block_bits_(1ULL << log_block_bits_),
+        log_super_bits_(log_block_bits_ + 3),
+        super_bits_(1ULL << log_super_bits_) {
+    allocate();
+  }
+
+  pss_tree_support(const uint64_t* data, const uint64_t bits)
+      : pss_tree_support(data, bits, incremental_type()) {
+    finish();
+  }
+
+  // Adds the blocks that lie within the first final_bits bits, which must not
+  // change anymore.
+  xss_always_inline void build_until(const uint64_t final_bits) {
+    const uint64_t blocks = std::min(final_bits, bits_) >> log_block_bits_;
+    while (built_blocks_ < blocks)
+      build_block(built_blocks_++);
+  }
+
+  void finish() {
+    const uint64_t blocks = (bits_ + block_bits_ - 1) >> log_block_bits_;
+    while (built_blocks_ < blocks)
+      build_block(built_blocks_++);
+
+    // the end of the BPS behaves like the beginning of another block
+    auto& last_entry = directory_[blocks >> 3];
+    if ((blocks & 7ULL) == 0)
+      last_entry.rank = built_ones_;
+    last_entry.block_rank[blocks & 7ULL] = built_ones_ - last_entry.rank;
+    push_select_sample((blocks > 0) ? (blocks - 1) : 0);
+
+    for (uint64_t v = leaves_ - 1; v > 0; --v)
+      min_tree_[v] = std::min(min_tree_[v << 1], min_tree_[(v << 1) + 1]);
+  }
+
+  template <typename bv_type>
+  pss_tree_support(const bv_type& bv)
+      : pss_tree_support(bv.data(), bv.size()) {}
+
+  // Size of the serialized support (a multiple of 64 bytes). The BPS itself
+  // is not part of it.
+  uint64_t serialized_bytes() const {
+    return 64 + directory_.size() * sizeof(directory_entry) +
+           padded(min_tree_.size() * sizeof(int64_t)) +
+           padded(select_absolute_.size() * sizeof(uint64_t)) +
+           padded(select_relative_.size() * sizeof(uint16_t));
+  }
+
+  // Writes serialized_bytes() bytes (the padding is zeroed).
+  void serialize(uint8_t* out) const {
+    memset(out, 0, serialized_bytes());
+    const uint64_t header[8] = {leaves_,
+                                directory_.size(),
+                                min_tree_.size(),
+                                select_samples_,
+                                built_blocks_,
+                                built_ones_,
+                                (uint64_t) built_excess_,
+                                log_block_bits_};
+    memcpy(out, header, sizeof(header));
+    out += 64;
+    // field by field, such that the padding of the entries stays zeroed
+    for (uint64_t e = 0; e < directory_.size(); ++e) {
+      const directory_entry& entry = directory_[e];
+      memcpy(out + offsetof(directory_entry, rank), &entry.rank,
+             sizeof(entry.rank));
+      memcpy(out + offsetof(directory_entry, block_rank), entry.block_rank,
+             sizeof(entry.block_rank));
+      memcpy(out + offsetof(directory_entry, block_min), entry.block_min,
+             sizeof(entry.block_min));
+      out += sizeof(directory_entry);
+    }
+    memcpy(out, min_tree_.data(), min_tree_.size() * sizeof(int64_t));
+    out += padded(min_tree_.size() * sizeof(int64_t));
+    memcpy(out, select_absolute_.data(),
+           select_absolute_.size() * sizeof(uint64_t));
+    out += padded(select_absolute_.size() * sizeof(uint64_t));
+    memcpy(out, select_relative_.data(),
+           select_relative_.size() * sizeof(uint16_t));
+  }
+
+  // Checks that a serialized support of at most the given number of bytes
+  // has the layout of a support for a BPS of the given length (the contents of
+  // the directory and the min-max tree are not verified).
+  static bool deserializable(const uint64_t bits,
+                             const uint8_t* serialized,
+                             const uint64_t serialized_bytes) {
+    if (serialized_bytes < 64)
+      return false;
+    uint64_t header[8];
+    memcpy(header, serialized, sizeof(header));
+    const uint64_t log_block_bits = log_block_bits_for(bits);
+    const uint64_t log_super_bits = log_block_bits + 3;
+    const uint64_t superblocks =
+        (bits + (1ULL << log_super_bits) - 1) >> log_super_bits;
+    const uint64_t blocks =
+        (bits + (1ULL << log_block_bits) - 1) >> log_block_bits;
+    uint64_t leaves = 1;
+    while (leaves < superblocks + 1)
+      leaves <<= 1;
+    const uint64_t ones = header[5];
+    const uint64_t samples = header[3];
+    if (header[0] != leaves || header[1] != superblocks + 1 ||
+        header[2] != (leaves << 1) || header[4] != blocks || ones > bits ||
+        header[7] != log_block_bits ||
+        samples != ((ones + (1ULL << log_block_bits) - 1) >> log_block_bits) +
+                       1)
+      return false;
+
+    const uint64_t groups = select_groups(samples);
+    const uint64_t absolute_offset = 64 +
+                                     header[1] * sizeof(directory_entry) +
+                                     padded(header[2] * sizeof(int64_t));
+    const uint64_t relative_offset =
+        absolute_offset + padded(groups * sizeof(uint64_t));
+    if (relative_offset + padded(samples * sizeof(uint16_t)) >
+        serialized_bytes)
+      return false;
+
+    // the samples (and their upper bounds) are used as block indices
+    for (uint64_t k = 0; k < samples; ++k) {
+      uint64_t absolute;
+      uint16_t relative;
+      memcpy(&absolute,
+             serialized + absolute_offset +
+                 (k >> log_select_group) * sizeof(uint64_t),
+             sizeof(uint64_t));
+      memcpy(&relative, serialized + relative_offset + k * sizeof(uint16_t),
+             sizeof(uint16_t));
+      if (absolute > blocks || relative > blocks - absolute)
+        return false;
+    }
+    return true;
+  }
+
+  // Restores a support that has been serialized for the given BPS. If the
+  // serialized support is not deserializable, it is rebuilt from the BPS.
+  pss_tree_support(const uint64_t* data,
+                   const uint64_t bits,
+                   const uint8_t* serialized,
+                   const uint64_t serialized_bytes)
+      : data_(data),
+        bytes_(reinterpret_cast<const uint8_t*>(data)),
+        bits_(bits),
+        log_block_bits_(log_block_bits_for(bits)),
+        block_bits_(1ULL << log_block_bits_),
+        log_super_bits_(log_block_bits_ + 3),
+        super_bits_(1ULL << log_super_bits_) {
+    restore(serialized, serialized_bytes, false);
+  }
+
+  // Like above, but if the serialized support is aligned to 64 bytes (like
+  // in a mapped file), it is used in place instead of being copied. Then the
+  // serialized support has to outlive this support (see is_view()).
+  pss_tree_support(const uint64_t* data,
+                   const uint64_t bits,
+                   const uint8_t* serialized,
+                   const uint64_t serialized_bytes,
+                   view_type)
+      : data_(data),
+        bytes_(reinterpret_cast<const uint8_t*>(data)),
+        bits_(bits),
+        log_block_bits_(log_block_bits_for(bits)),
+        block_bits_(1ULL << log_block_bits_),
+        log_super_bits_(log_block_bits_ + 3),
+        super_bits_(1ULL << log_super_bits_) {
+    restore(serialized, serialized_bytes, ((uintptr_t) serialized & 63) == 0);
+  }
+
+  // the support points into a serialized support
+  bool is_view() const {
+    return directory_.is_view();
+  }
+
+  // number of opening parentheses in [0, idx)
+  xss_always_inline uint64_t rank(const uint64_t idx) const {
+    const uint64_t block = idx >> log_block_bits_;
+    uint64_t result = ones_before_block(block);
+    const uint64_t* block_words = data_ + (block << (log_block_bits_ - 6));
+    const uint64_t word = (idx >> 6) & ((block_bits_ >> 6) - 1);
+    for (uint64_t w = 0; w < word; ++w)
+      result += __builtin_popcountll(block_words[w]);
+    if (idx & 63ULL)
+      result += __builtin_popcountll(block_words[word] &
+                                     ((1ULL << (idx & 63ULL)) - 1));
+    return result;
+  }
+
+  // position of the k-th (1-based) opening parenthesis
+  xss_always_inline uint64_t select(const uint64_t k) const {
+    const uint64_t sample = (k - 1) >> log_block_bits_;
+    uint64_t lo = select_lower_bound(sample);
+    uint64_t hi = select_upper_bound(sample + 1);
+    while (lo < hi) {
+      const uint64_t mid = (lo + hi + 1) >> 1;
+      if (ones_before_block(mid) < k)
+        lo = mid;
+      else
+        hi = mid - 1;
+    }
+
+    uint64_t remaining = k - ones_before_block(lo);
+    const uint64_t* block_words = data_ + (lo << (log_block_bits_ - 6));
+    for (uint64_t w = 0;; ++w) {
+      const uint64_t count = __builtin_popcountll(block_words[w]);
+      if (remaining <= count) {
+        return (lo << log_block_bits_) + (w << 6) +
+               internal::select_in_word(block_words[w], remaining);
+      }
+      remaining -= count;
+    }
+  }
+
+  // smallest j > idx such that the excess of [0, j] is at most target
+  uint64_t forward_search(const uint64_t idx, const int64_t target) const {
+    uint64_t j = idx + 1;
+    int64_t excess = excess_before(j);
+
+    for (; j & 7ULL; ++j) {
+      excess += get(j) ? 1 : -1;
+      if (excess <= target)
+        return j;
+    }
+    if (j & (block_bits_ - 1)) {
+      const uint64_t end = ((j >> log_block_bits_) + 1) << log_block_bits_;
+      if (forward_bytes(j, end, excess, target))
+        return j;
+    }
+    for (; j & (super_bits_ - 1); j += block_bits_) {
+      if (excess + block_min(j >> log_block_bits_) <= target) {
+        forward_bytes(j, j + block_bits_, excess, target);
+        return j;
+      }
+      excess = excess_before(j + block_bits_);
+    }
+
+    const uint64_t s = next_superblock(j >> log_super_bits_, target);
+    if (s >= leaves_)
+      return bits_;
+    j = s << log_super_bits_;
+    excess = excess_before(j);
+    while (excess + block_min(j >> log_block_bits_) > target) {
+      j += block_bits_;
+      excess = excess_before(j);
+    }
+    forward_bytes(j, j + block_bits_, excess, target);
+    return j;
+  }
+
+  // largest j < idx such that the excess of [0, j] is at most target (or -1,
+  // which represents the empty prefix with excess 0)
+  int64_t backward_search(const uint64_t idx, const int64_t target) const {
+    uint64_t j = idx;
+    int64_t excess = excess_before(j);
+
+    for (; j & 7ULL; --j) {
+      if (excess <= target)
+        return (int64_t) j - 1;
+      excess -= get(j - 1) ? 1 : -1;
+    }
+    if (j & (block_bits_ - 1)) {
+      const uint64_t begin = (j >> log_block_bits_) << log_block_bits_;
+      if (backward_bytes(j, begin, excess, target))
+        return (int64_t) j - 1;
+    }
+    for (; j & (super_bits_ - 1); j -= block_bits_) {
+      const int64_t excess_before_block = excess_before(j - block_bits_);
+      if (excess <= target ||
+          excess_before_block + block_min((j >> log_block_bits_) - 1) <=
+              target) {
+        backward_bytes(j, j - block_bits_, excess, target);
+        return (int64_t) j - 1;
+      }
+      excess = excess_before_block;
+    }
+    if (excess <= target)
+      return (int64_t) j - 1;
+
+    const uint64_t s = previous_superblock(j >> log_super_bits_, target);
+    if (s >= leaves_)
+      return -1;
+    j = (s + 1) << log_super_bits_;
+    excess = excess_before(j);
+    while (true) {
+      const int64_t excess_before_block = excess_before(j - block_bits_);
+      if (excess <= target ||
+          excess_before_block + block_min((j >> log_block_bits_) - 1) <=
+              target) {
+        backward_bytes(j, j - block_bits_, excess, target);
+        return (int64_t) j - 1;
+      }
+      j -= block_bits_;
+      excess = excess_before_block;
+    }
+  }
+
+  xss_always_inline uint64_t enclose(const uint64_t bps_idx) const {
+    const int64_t target = excess_before(bps_idx) - (get(bps_idx) ? 1 : 2);
+    return backward_search(bps_idx, target) + 1;
+  }
+
+  xss_always_inline uint64_t find_close(const uint64_t bps_idx) const {
+    if (!get(bps_idx))
+      return bps_idx;
+    return forward_search(bps_idx, excess_before(bps_idx));
+  }
+
+  xss_always_inline uint64_t parent_distance(const uint64_t bps_idx) const {
+    const uint64_t bps_idx_open_parent = enclose(bps_idx);
+    return (bps_idx - bps_idx_open_parent + 1) >> 1;
+  }
+
+  xss_always_inline uint64_t subtree_size(const uint64_t bps_idx) const {
+    const uint64_t bps_idx_close_nss = find_close(bps_idx);
+    return (bps_idx_close_nss - bps_idx + 1) >> 1;
+  }
+
+  xss_always_inline uint64_t pss(const uint64_t preorder_number) const {
+    const uint64_t bps_idx_open_node = select(preorder_number + 2);
+    const uint64_t parent_dist = parent_distance(bps_idx_open_node);
+    return preorder_number - parent_dist;
+  }
+
+  xss_always_inline uint64_t nss(const uint64_t preorder_number) const {
+    const uint64_t bps_idx_open_node = select(preorder_number + 2);
+    const uint64_t subtree = subtree_size(bps_idx_open_node);
+    return preorder_number + subtree;
+  }
+
+  xss_always_inline uint64_t lyndon(const uint64_t preorder_number) const {
+    return nss(preorder_number) - preorder_number;
+  }
+
+  void pss_batch(const uint64_t* preorder_numbers,
+                 uint64_t* out,
+                 const uint64_t k) const {
+    batch(preorder_numbers, out, k,
+          [&](const uint64_t preorder_number, const uint64_t bps_idx) {
+            return preorder_number - parent_distance(bps_idx);
+          });
+  }
+
+  void nss_batch(const uint64_t* preorder_numbers,
+                 uint64_t* out,
+                 const uint64_t k) const {
+    batch(preorder_numbers, out, k,
+          [&](const uint64_t preorder_number, const uint64_t bps_idx) {
+            return preorder_number + subtree_size(bps_idx);
+          });
+  }
+
+  void lyndon_batch(const uint64_t* preorder_numbers,
+                    uint64_t* out,
+                    const uint64_t k) const {
+    batch(preorder_numbers, out, k,
+          [&](const uint64_t, const uint64_t bps_idx) {
+            return subtree_size(bps_idx);
+          });
+  }
+};
+
+} // namespace xss